@@ -0,0 +1,316 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include "utflib/validate.h"
+#include "utflib/encoders.h"
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include <clocale>
+#include <cuchar>
+#include <cwchar>
+#include <locale>
+#include <bit>
+#include <map>
+#include <string>
+#include <vector>
+#include <optional>
+#ifdef UTFLIB_HAVE_ICONV
+#include <iconv.h>
+#endif
+
+
+//
+// Baselines
+//
+// utflib against what ships w/ the platform, on the same data:  iconv(3) (if found), mbrtoc32/c32rtomb
+// in a utf-8 locale, and the std::codecvt<char32_t,char8_t,std::mbstate_t> facet.  Built only w/
+// -DUTFLIB_BENCHMARK_BASELINES=ON, as the benchmarks_baselines target.
+//
+// Names are <encoding>_<operation>_<impl>_<data>, ex u8_to_u32_iconv_cjk_262144.  The data is dataset 2
+// and the 256 KiB generated corpora (see corpus_gen.cpp).  Operations:
+//   u8_validate:  find the end of the valid prefix (iconv has no validator; see u8_to_u32)
+//   u8_to_u32:    decode into a buffer
+//   u32_to_u8:    encode into a buffer
+// The utflib entries use the routines a caller would reach for first:  validate_utf8, utf8_iterator_alt
+// and to_codepoint() + encode_utf8.
+
+using u32_codecvt = std::codecvt<char32_t,char8_t,std::mbstate_t>;
+
+static const u32_codecvt& get_codecvt() {
+	return std::use_facet<u32_codecvt>(std::locale::classic());
+}
+
+// Named inputs in utf-8 and utf-32.  c32 holds the same values as u32, for the std:: converters that
+// take char32_t:  a uint32_t can't be read through a char32_t*.
+struct baseline_data {
+	std::span<const std::uint8_t> u8;
+	std::vector<std::uint32_t> u32;
+	std::vector<char32_t> c32;
+};
+static const baseline_data& get_baseline_data(const std::string& name) {
+	static std::map<std::string,baseline_data> cache;
+	auto it = cache.find(name);
+	if (it == cache.end()) {
+		baseline_data d;
+		d.u8 = (name == "dataset_2") ? get_random_codepoints_dataset_2_utf8() : get_corpus(name);
+		for (utf8_iterator_alt i {d.u8}; !i.is_finished(); i.go_next()) {
+			d.u32.push_back(i.get_codepoint()->get());
+		}
+		d.c32.assign(d.u32.begin(), d.u32.end());
+		it = cache.emplace(name, std::move(d)).first;
+	}
+	return it->second;
+}
+
+
+//
+// utf-8 validation
+//
+static void u8_validate_utflib(benchmark::State& state, std::span<const std::uint8_t> s) {
+	for (auto _ : state) {
+		std::size_t n = validate_utf8(s);
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+static void u8_validate_mbrtoc32(benchmark::State& state, std::span<const std::uint8_t> s) {
+	for (auto _ : state) {
+		std::mbstate_t st {};
+		std::size_t i {0};
+		char32_t c {};
+		while (i < s.size()) {
+			std::size_t r = std::mbrtoc32(&c, reinterpret_cast<const char*>(s.data()+i), s.size()-i, &st);
+			if (r == 0) {
+				r = 1;  // Decoded U+0000
+			} else if (r > s.size()-i) {
+				break;  // (size_t)-1 or -2:  invalid or truncated
+			}
+			i += r;
+		}
+		benchmark::DoNotOptimize(i);
+	}
+}
+
+static void u8_validate_codecvt(benchmark::State& state, std::span<const std::uint8_t> s) {
+	const u32_codecvt& cvt = get_codecvt();
+	const char8_t* p = reinterpret_cast<const char8_t*>(s.data());
+	for (auto _ : state) {
+		std::mbstate_t st {};
+		int n = cvt.length(st, p, p+s.size(), INT_MAX);
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+
+//
+// utf-8 -> utf-32
+//
+static void u8_to_u32_utflib(benchmark::State& state, std::span<const std::uint8_t> s) {
+	std::vector<std::uint32_t> dest(s.size());
+	for (auto _ : state) {
+		std::uint32_t* p = dest.data();
+		for (utf8_iterator_alt it {s}; !it.is_finished(); it.go_next()) {
+			std::optional<codepoint> cp = it.get_codepoint();
+			*p++ = cp ? cp->get() : 0xFFFDu;
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+}
+
+static void u8_to_u32_mbrtoc32(benchmark::State& state, std::span<const std::uint8_t> s) {
+	std::vector<char32_t> dest(s.size());
+	for (auto _ : state) {
+		std::mbstate_t st {};
+		char32_t* p = dest.data();
+		std::size_t i {0};
+		while (i < s.size()) {
+			std::size_t r = std::mbrtoc32(p, reinterpret_cast<const char*>(s.data()+i), s.size()-i, &st);
+			if (r == 0) {
+				r = 1;
+			} else if (r > s.size()-i) {
+				*p = 0xFFFDu;
+				st = {};
+				r = 1;
+			}
+			++p;
+			i += r;
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+}
+
+static void u8_to_u32_codecvt(benchmark::State& state, std::span<const std::uint8_t> s) {
+	const u32_codecvt& cvt = get_codecvt();
+	std::vector<char32_t> dest(s.size());
+	const char8_t* from = reinterpret_cast<const char8_t*>(s.data());
+	for (auto _ : state) {
+		std::mbstate_t st {};
+		const char8_t* from_next {};
+		char32_t* to_next {};
+		auto r = cvt.in(st, from, from+s.size(), from_next, dest.data(), dest.data()+dest.size(), to_next);
+		benchmark::DoNotOptimize(r);
+		benchmark::DoNotOptimize(to_next);
+	}
+}
+
+
+//
+// utf-32 -> utf-8
+//
+static void u32_to_u8_utflib(benchmark::State& state, std::span<const std::uint32_t> s) {
+	std::vector<std::uint8_t> dest(4*s.size() + 3);
+	for (auto _ : state) {
+		std::uint8_t* p = dest.data();
+		for (std::uint32_t v : s) {
+			std::optional<codepoint> cp = codepoint::to_codepoint(v);
+			p = encode_utf8(cp ? *cp : *codepoint::to_codepoint(0xFFFDu), p);
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+}
+
+static void u32_to_u8_c32rtomb(benchmark::State& state, std::span<const char32_t> s) {
+	std::vector<char> dest(MB_LEN_MAX*s.size());
+	for (auto _ : state) {
+		std::mbstate_t st {};
+		char* p = dest.data();
+		for (char32_t c : s) {
+			std::size_t r = std::c32rtomb(p, c, &st);
+			if (r == static_cast<std::size_t>(-1)) {
+				st = {};
+				r = 0;
+			}
+			p += r;
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+}
+
+static void u32_to_u8_codecvt(benchmark::State& state, std::span<const char32_t> s) {
+	const u32_codecvt& cvt = get_codecvt();
+	std::vector<char8_t> dest(4*s.size());
+	const char32_t* from = s.data();
+	for (auto _ : state) {
+		std::mbstate_t st {};
+		const char32_t* from_next {};
+		char8_t* to_next {};
+		auto r = cvt.out(st, from, from+s.size(), from_next, dest.data(), dest.data()+dest.size(), to_next);
+		benchmark::DoNotOptimize(r);
+		benchmark::DoNotOptimize(to_next);
+	}
+}
+
+
+//
+// iconv
+//
+#ifdef UTFLIB_HAVE_ICONV
+static const char* iconv_utf32_native() {
+	return (std::endian::native == std::endian::little) ? "UTF-32LE" : "UTF-32BE";
+}
+
+// Converts all of src; returns false on the first ill-formed sequence.  cd is reset first.
+static bool iconv_all(iconv_t cd, std::span<const std::byte> src, std::span<std::byte> dest) {
+	iconv(cd, nullptr, nullptr, nullptr, nullptr);
+	char* in = const_cast<char*>(reinterpret_cast<const char*>(src.data()));
+	std::size_t n_in = src.size();
+	char* out = reinterpret_cast<char*>(dest.data());
+	std::size_t n_out = dest.size();
+	return iconv(cd, &in, &n_in, &out, &n_out) != static_cast<std::size_t>(-1);
+}
+
+static void iconv_convert(benchmark::State& state, const char* to, const char* from, std::span<const std::byte> src,
+		std::size_t dest_size) {
+	iconv_t cd = iconv_open(to, from);
+	if (cd == reinterpret_cast<iconv_t>(-1)) {
+		state.SkipWithError("iconv_open failed");
+		return;
+	}
+	std::vector<std::byte> dest(dest_size);
+	for (auto _ : state) {
+		bool ok = iconv_all(cd, src, dest);
+		benchmark::DoNotOptimize(ok);
+		benchmark::DoNotOptimize(dest);
+	}
+	iconv_close(cd);
+}
+
+static void u8_to_u32_iconv(benchmark::State& state, std::span<const std::uint8_t> s) {
+	iconv_convert(state, iconv_utf32_native(), "UTF-8", std::as_bytes(s), 4*s.size());
+}
+
+static void u32_to_u8_iconv(benchmark::State& state, std::span<const std::uint32_t> s) {
+	iconv_convert(state, "UTF-8", iconv_utf32_native(), std::as_bytes(s), 4*s.size());
+}
+#endif
+
+
+//
+// Registration
+//
+using u8_benchmark = void(*)(benchmark::State&, std::span<const std::uint8_t>);
+using u32_benchmark = void(*)(benchmark::State&, std::span<const std::uint32_t>);
+using c32_benchmark = void(*)(benchmark::State&, std::span<const char32_t>);
+
+static void register_u8(const std::string& op, const std::string& impl, u8_benchmark f, const std::string& data) {
+	benchmark::RegisterBenchmark((op + "_" + impl + "_" + data).c_str(), [f, data](benchmark::State& st){
+		const baseline_data& d = get_baseline_data(data);
+		f(st, d.u8);
+		set_throughput(st, d.u8.size_bytes(), d.u32.size());
+	});
+}
+
+static void register_u32(const std::string& op, const std::string& impl, u32_benchmark f, const std::string& data) {
+	benchmark::RegisterBenchmark((op + "_" + impl + "_" + data).c_str(), [f, data](benchmark::State& st){
+		const baseline_data& d = get_baseline_data(data);
+		f(st, d.u32);
+		set_throughput(st, std::span<const std::uint32_t>(d.u32).size_bytes(), d.u32.size());
+	});
+}
+
+static void register_c32(const std::string& op, const std::string& impl, c32_benchmark f, const std::string& data) {
+	benchmark::RegisterBenchmark((op + "_" + impl + "_" + data).c_str(), [f, data](benchmark::State& st){
+		const baseline_data& d = get_baseline_data(data);
+		f(st, d.c32);
+		set_throughput(st, std::span<const char32_t>(d.c32).size_bytes(), d.c32.size());
+	});
+}
+
+static const int baseline_benchmarks_registered = [](){
+	// mbrtoc32 & c32rtomb convert from/to the multibyte encoding of the current locale
+	const bool have_utf8_locale = std::setlocale(LC_CTYPE, "C.UTF-8") || std::setlocale(LC_CTYPE, "en_US.UTF-8");
+
+	std::vector<std::string> data {"dataset_2"};
+	for (const std::string& name : get_corpus_names()) {
+		if (name.ends_with("_262144")) {
+			data.push_back(name);
+		}
+	}
+
+	for (const std::string& d : data) {
+		register_u8("u8_validate", "utflib", u8_validate_utflib, d);
+		register_u8("u8_validate", "codecvt", u8_validate_codecvt, d);
+		register_u8("u8_to_u32", "utflib", u8_to_u32_utflib, d);
+		register_u8("u8_to_u32", "codecvt", u8_to_u32_codecvt, d);
+		register_u32("u32_to_u8", "utflib", u32_to_u8_utflib, d);
+		register_c32("u32_to_u8", "codecvt", u32_to_u8_codecvt, d);
+		if (have_utf8_locale) {
+			register_u8("u8_validate", "mbrtoc32", u8_validate_mbrtoc32, d);
+			register_u8("u8_to_u32", "mbrtoc32", u8_to_u32_mbrtoc32, d);
+			register_c32("u32_to_u8", "c32rtomb", u32_to_u8_c32rtomb, d);
+		}
+#ifdef UTFLIB_HAVE_ICONV
+		register_u8("u8_to_u32", "iconv", u8_to_u32_iconv, d);
+		register_u32("u32_to_u8", "iconv", u32_to_u8_iconv, d);
+#endif
+	}
+	return 0;
+}();
@@ -3,6 +3,16 @@
 #include <span>
 #include <cstdint>
 #include <array>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <map>
+#include <utility>
+#include <filesystem>
+#include <fstream>
+#include "utflib/byte_manip.h"
+#include "utflib/low_level.h"
 
 std::span<const std::uint8_t> get_utf8_equal_probability_code_unit_seq_length_dataset_1() {
 	static constexpr std::array<const std::uint8_t,2*2572> d {
@@ -5332,8 +5342,74 @@ std::span<const std::uint8_t> get_random_codepoints_dataset_2_utf8() {
 	return d;
 }
 
+std::span<const std::uint32_t> get_random_codepoints_dataset_2_utf32_swapped() {
+	static const std::vector<std::uint32_t> d = [](){
+		std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+		std::vector<std::uint32_t> r(s.size());
+		byteswap_utf32(s, r);
+		return r;
+	}();
+	return d;
+}
+
+std::span<const std::uint16_t> get_random_codepoints_dataset_2_utf16_swapped() {
+	static const std::vector<std::uint16_t> d = [](){
+		std::span<const std::uint16_t> s = get_random_codepoints_dataset_2_utf16();
+		std::vector<std::uint16_t> r(s.size());
+		byteswap_utf16(s, r);
+		return r;
+	}();
+	return d;
+}
+
+
+std::size_t count_codepoints(std::span<const std::uint8_t> s) {
+	return std::count_if(s.begin(), s.end(), [](std::uint8_t b){ return !is_utf8_trailing_byte(b); });
+}
 
+std::size_t count_codepoints(std::span<const std::uint16_t> s) {
+	return std::count_if(s.begin(), s.end(), [](std::uint16_t w){ return !is_valid_utf16_surrogate_pair_trailing(w); });
+}
 
+std::size_t count_codepoints(std::span<const std::uint32_t> s) {
+	return s.size();
+}
 
 
+//
+// Generated corpora
+//
+std::span<const std::uint8_t> get_corpus(const std::string& name) {
+	static std::map<std::string,std::vector<std::uint8_t>> corpora;
+	auto it = corpora.find(name);
+	if (it == corpora.end()) {
+		const std::filesystem::path fp = std::filesystem::path(UTFLIB_CORPUS_DIR) / (name + ".txt");
+		std::vector<std::uint8_t> d;
+		std::error_code ec;
+		const std::uintmax_t sz = std::filesystem::file_size(fp, ec);
+		std::ifstream f(fp, std::ios::binary);
+		if (!ec && f) {
+			d.resize(sz);
+			f.read(reinterpret_cast<char*>(d.data()), d.size());
+		}
+		it = corpora.emplace(name, std::move(d)).first;
+	}
+	return it->second;
+}
 
+std::vector<std::string> get_corpus_names() {
+	// UTFLIB_CORPUS_NAMES is the list the build generated, comma-separated (see benchmarks/CMakeLists.txt),
+	// rather than whatever is in UTFLIB_CORPUS_DIR, which may hold stale corpora from an earlier build
+	// w/ a larger UTFLIB_CORPUS_MAX_SIZE.
+	std::vector<std::string> r;
+	const std::string_view names {UTFLIB_CORPUS_NAMES};
+	std::size_t i {0};
+	while (i < names.size()) {
+		const std::size_t j = std::min(names.find(',', i), names.size());
+		if (j > i) {
+			r.emplace_back(names.substr(i, j-i));
+		}
+		i = j+1;
+	}
+	return r;
+}
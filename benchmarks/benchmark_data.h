@@ -1,6 +1,11 @@
 #pragma once
+#include <benchmark/benchmark.h>
+#include "perf_counters.h"
 #include <span>
 #include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
 
 
 
@@ -14,5 +19,46 @@ std::span<const std::uint8_t> get_utf8_equal_probability_code_unit_seq_length_da
 std::span<const std::uint32_t> get_random_codepoints_dataset_2_utf32();
 std::span<const std::uint16_t> get_random_codepoints_dataset_2_utf16();
 std::span<const std::uint8_t> get_random_codepoints_dataset_2_utf8();
+// The utf16 and utf32 versions byte-swapped, for the _swapping iterators and _swapped validators
+std::span<const std::uint32_t> get_random_codepoints_dataset_2_utf32_swapped();
+std::span<const std::uint16_t> get_random_codepoints_dataset_2_utf16_swapped();
 
 
+//
+// Generated corpora
+//
+// Realistic text in several scripts, generated by the build (see corpus_gen.cpp); name is
+// <model>_<size>, ex "cyrillic_4096".  Read on first use and kept in memory.  Empty if the corpus was
+// not generated (sizes above UTFLIB_CORPUS_MAX_SIZE are skipped).
+std::span<const std::uint8_t> get_corpus(const std::string& name);
+
+// The names of the corpora the build generates (per UTFLIB_CORPUS_MAX_SIZE), ordered by model then
+// size; other files in the corpus directory are ignored
+std::vector<std::string> get_corpus_names();
+
+//
+// Throughput
+//
+// Naming:  <encoding>_<operation>[_<variant>]_<dataset>, ex u8_iter_fwd_dataset_1, u32_to_u8_encode_utf8_dataset_2.
+// The encoding is that of the input (u8, u16, u32, or u32_to_u8 etc for transcoding); the dataset is
+// dataset_1, dataset_2 or a short name for data generated in the benchmark file.  Every benchmark
+// reports bytes/s of input and items/s, where an item is a codepoint of input, so that results compare
+// across datasets and encodings.
+
+// The number of codepoints in valid utf-8, utf-16 (native byte order) or utf-32
+std::size_t count_codepoints(std::span<const std::uint8_t>);
+std::size_t count_codepoints(std::span<const std::uint16_t>);
+std::size_t count_codepoints(std::span<const std::uint32_t>);
+
+// Call once after the timing loop; n_bytes and n_codepoints are per iteration.  Also reports the
+// hardware counters, if enabled (see perf_counters.h).
+inline void set_throughput(benchmark::State& state, std::size_t n_bytes, std::size_t n_codepoints) {
+	report_perf_counters(state, n_bytes);
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * n_bytes));
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n_codepoints));
+}
+
+template<typename T>
+void set_throughput(benchmark::State& state, std::span<const T> s) {
+	set_throughput(state, s.size_bytes(), count_codepoints(s));
+}
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include "utflib/validate.h"
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+
+//
+// Generated corpora
+//
+// Registered at startup for each corpus the build generated (see corpus_gen.cpp), ex
+// u8_validate_english_64 ... u8_validate_mixed_logs_16777216.  Unlike datasets 1 and 2, which are
+// uniformly random codepoints, these are mostly ascii or mostly one script, like real text.
+
+static void u8_validate_corpus(benchmark::State& state, const std::string& name) {
+	std::span<const std::uint8_t> s = get_corpus(name);
+	for (auto _ : state) {
+		std::size_t i = validate_utf8(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+
+static void u8_scan_corpus(benchmark::State& state, const std::string& name) {
+	std::span<const std::uint8_t> s = get_corpus(name);
+	for (auto _ : state) {
+		utf8_scan_report r = scan_utf8(s);
+		benchmark::DoNotOptimize(r);
+	}
+	set_throughput(state, s);
+}
+
+static void u8_iter_fwd_corpus(benchmark::State& state, const std::string& name) {
+	std::span<const std::uint8_t> s = get_corpus(name);
+	for (auto _ : state) {
+		utf8_iterator it {s};
+		while (!it.is_finished()) {
+			it.go_next();
+		}
+		benchmark::DoNotOptimize(it);
+	}
+	set_throughput(state, s);
+}
+
+static const int corpus_benchmarks_registered = [](){
+	for (const std::string& name : get_corpus_names()) {
+		benchmark::RegisterBenchmark(("u8_validate_" + name).c_str(), u8_validate_corpus, name);
+		benchmark::RegisterBenchmark(("u8_scan_" + name).c_str(), u8_scan_corpus, name);
+		benchmark::RegisterBenchmark(("u8_iter_fwd_" + name).c_str(), u8_iter_fwd_corpus, name);
+	}
+	return 0;
+}();
@@ -0,0 +1,119 @@
+#include "utils.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+
+// usage:  corpus_gen <out_dir> <model> <size>
+// Writes <out_dir>/<model>_<size>.txt:  size bytes of well-formed utf-8 text in the style of the named
+// model (see get_model() below).  Each model has a fixed seed and a smaller corpus is a prefix of a
+// larger one, up to the last partial line.  The output depends only on the arguments and the standard
+// library's default_random_engine and distributions, so it is reproducible w/ a given toolchain but
+// not necessarily across toolchains.
+//
+// Run by the build (see benchmarks/CMakeLists.txt); the corpora are not committed.
+
+
+static utf8_text_model get_model(std::string_view name) {
+	utf8_text_model m {};
+	if (name == "english") {
+		m.letters = {{0x61u, 0x7Au, 95.0}, {0x41u, 0x5Au, 4.0}, {0x30u, 0x39u, 1.0}};
+	} else if (name == "latin1") {
+		// Western European:  mostly ascii letters w/ some accented letters from Latin-1 Supplement
+		m.letters = {{0x61u, 0x7Au, 85.0}, {0x41u, 0x5Au, 3.0}, {0xE0u, 0xFFu, 10.0}, {0xC0u, 0xDEu, 2.0}};
+	} else if (name == "cyrillic") {
+		m.letters = {{0x430u, 0x44Fu, 92.0}, {0x410u, 0x42Fu, 5.0}, {0x30u, 0x39u, 1.0}, {0x61u, 0x7Au, 2.0}};
+	} else if (name == "cjk") {
+		// CJK Unified Ideographs w/ some Hiragana; no spaces between words
+		m.letters = {{0x4E00u, 0x9FFFu, 80.0}, {0x3041u, 0x3096u, 20.0}};
+		m.word_sep = 0;
+		m.punct = {0x3001u, 0x3002u};
+		m.p_punct = 0.3;
+		m.min_word_len = 2;
+		m.max_word_len = 6;
+	} else if (name == "emoji_chat") {
+		// Short lines of mostly ascii w/ emoji (all 4-byte sequences)
+		m.letters = {{0x61u, 0x7Au, 80.0}, {0x1F600u, 0x1F64Fu, 15.0}, {0x1F300u, 0x1F5FFu, 5.0}};
+		m.punct = {0x21u, 0x3Fu, 0x2Eu};
+		m.min_words_per_line = 1;
+		m.max_words_per_line = 8;
+	} else if (name == "mixed_logs") {
+		// Log lines:  an ascii timestamp & level, then messages mostly in ascii w/ a little of everything
+		m.letters = {{0x61u, 0x7Au, 60.0}, {0x30u, 0x39u, 15.0}, {0xE0u, 0xFFu, 6.0}, {0x430u, 0x44Fu, 8.0},
+			{0x4E00u, 0x9FFFu, 8.0}, {0x1F600u, 0x1F64Fu, 3.0}};
+		m.punct = {0x3Au, 0x3Du, 0x2Cu, 0x2Fu};
+		m.log_prefix = true;
+	}
+	return m;
+}
+
+static std::uint32_t get_seed(std::string_view name) {
+	std::uint32_t seed {0x5EEDu};
+	for (char c : name) {
+		seed = seed*31 + static_cast<std::uint8_t>(c);
+	}
+	return seed;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 4) {
+		std::fprintf(stderr, "usage:  corpus_gen <out_dir> <model> <size>\n");
+		return 2;
+	}
+	const std::filesystem::path out_dir {argv[1]};
+	const std::string model_name {argv[2]};
+	const std::size_t size = std::strtoull(argv[3], nullptr, 10);
+
+	utf8_text_model m = get_model(model_name);
+	if (m.letters.empty()) {
+		std::fprintf(stderr, "corpus_gen:  unknown model %s\n", model_name.c_str());
+		return 2;
+	}
+
+	std::filesystem::create_directories(out_dir);
+	const std::filesystem::path fp = out_dir / (model_name + "_" + std::to_string(size) + ".txt");
+	file_raii f(std::fopen(fp.string().c_str(), "wb"));
+	if (!f) {
+		std::fprintf(stderr, "corpus_gen:  could not open %s\n", fp.string().c_str());
+		return 1;
+	}
+
+	// Generated a line at a time and written in blocks, so that a 1 GiB corpus does not need to be held
+	// in memory.  A line that would overrun size is cut at its last codepoint boundary that fits, and the
+	// corpus is padded to exactly size bytes w/ 0x0A.
+	std::default_random_engine re(get_seed(model_name));
+	std::vector<std::uint8_t> block;
+	std::vector<std::uint8_t> line;
+	std::size_t n_written {0};
+	while (n_written < size) {
+		line.clear();
+		random_utf8_text_line(m, re, std::back_inserter(line));
+		std::size_t n = line.size();
+		if (n_written + block.size() + n > size) {
+			n = size - n_written - block.size();
+			while (n > 0 && is_utf8_trailing_byte(line[n])) {
+				--n;
+			}
+			line.resize(n);
+			line.resize(size - n_written - block.size(), 0x0Au);
+		}
+		block.insert(block.end(), line.begin(), line.end());
+		if (block.size() >= (1<<20) || n_written + block.size() == size) {
+			if (std::fwrite(block.data(), 1, block.size(), f) != block.size()) {
+				std::fprintf(stderr, "corpus_gen:  error writing %s\n", fp.string().c_str());
+				return 1;
+			}
+			n_written += block.size();
+			block.clear();
+		}
+	}
+	return 0;
+}
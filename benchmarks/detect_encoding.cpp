@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/detect.h"
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+
+//
+// Encoding detection
+//
+// With the default prefix length, detect_encoding looks at the first 4 KiB of dataset 2.  Dataset 2 is
+// mostly non-ascii w/ many surrogate pairs, so nearly everything goes through the scalar paths; text
+// that is mostly ascii is faster.
+
+static void u8_detect_encoding_dataset_2(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_random_codepoints_dataset_2_utf8();
+	for (auto _ : state) {
+		detected_encoding r = detect_encoding(s);
+		benchmark::DoNotOptimize(r);
+	}
+	set_throughput(state, s.first(std::min<std::size_t>(s.size(), 4096)));
+}
+BENCHMARK(u8_detect_encoding_dataset_2);
+
+static void u16_detect_encoding_dataset_2(benchmark::State& state) {
+	std::span<const std::uint16_t> s16 = get_random_codepoints_dataset_2_utf16();
+	std::span<const std::uint8_t> s(reinterpret_cast<const std::uint8_t*>(s16.data()), s16.size_bytes());
+	for (auto _ : state) {
+		detected_encoding r = detect_encoding(s);
+		benchmark::DoNotOptimize(r);
+	}
+	set_throughput(state, s.first(std::min<std::size_t>(s.size(), 4096)));
+}
+BENCHMARK(u16_detect_encoding_dataset_2);
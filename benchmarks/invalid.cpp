@@ -0,0 +1,444 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include "utflib/validate.h"
+#include "utflib/line_index.h"
+#include "utflib/byte_manip.h"
+#include "utflib/low_level.h"
+#include "utflib/detect.h"
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <string>
+#include <random>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+
+//
+// Ill-formed input
+//
+// Dataset 2 w/ errors of one class inserted between codepoints at a controlled density:  before each
+// codepoint an error is inserted w/ probability 0.01%, 1% or 50%.  The errors never merge w/ the
+// neighbouring codepoints, so each insertion is one ill-formed subsequence (or a run of them, for
+// lone_continuation).  Names are <encoding>_<operation>_invalid_<class>_<density>, ex
+// u8_iter_fwd_invalid_overlong_1pct.  items/s counts the codepoints of the valid text plus the leading
+// code units of the errors, so it is approximate.
+//
+// The byte-swapped variants (_swapping, _swapped, byteswap_and_validate) run on the same data w/ every
+// code unit byte-swapped; their items/s counts the codepoints of the data before swapping.
+// detect_encoding is given the whole input as its prefix, so that it meets the errors at every density.
+//
+// The iterators take their invalid-subsequence paths for every error (go_next re-runs the predicate
+// at each following code unit until one begins a valid sequence), so long runs of junk are where
+// they are slowest.
+
+struct error_density {
+	const char* name {};
+	double p {};
+};
+static constexpr std::array<error_density,3> densities {{{"0.01pct", 0.0001}, {"1pct", 0.01}, {"50pct", 0.5}}};
+
+// Each generates one error and appends it to out
+template<typename T>
+using error_generator = void(*)(std::default_random_engine&, std::vector<T>&);
+
+template<typename T>
+struct error_class {
+	const char* name {};
+	error_generator<T> gen {};
+};
+
+
+//
+// utf-8
+//
+// The lines of data/invalid.txt (c3 28, a0 a1, e2 28 a1, ...), chosen at random
+static const std::vector<std::vector<std::uint8_t>>& get_seed_errors_utf8() {
+	static const std::vector<std::vector<std::uint8_t>> errs = [](){
+		std::vector<std::vector<std::uint8_t>> r;
+		std::ifstream f(UTFLIB_DATA_DIR "/invalid.txt", std::ios::binary);
+		std::vector<std::uint8_t> d((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+		std::vector<std::uint8_t> line;
+		for (std::uint8_t b : d) {
+			if (b == 0x0Au) {
+				if (!line.empty()) {
+					r.push_back(line);
+				}
+				line.clear();
+			} else {
+				line.push_back(b);
+			}
+		}
+		if (!line.empty()) {
+			r.push_back(line);
+		}
+		return r;
+	}();
+	return errs;
+}
+
+static void gen_u8_seed(std::default_random_engine& re, std::vector<std::uint8_t>& out) {
+	const auto& errs = get_seed_errors_utf8();
+	std::uniform_int_distribution<std::size_t> d(0, errs.size()-1);
+	const auto& e = errs[d(re)];
+	out.insert(out.end(), e.begin(), e.end());
+}
+
+// C0, C1, F5-FF:  never valid anywhere
+static void gen_u8_bad_leading(std::default_random_engine& re, std::vector<std::uint8_t>& out) {
+	std::uniform_int_distribution<int> d(0, 12);
+	const int i = d(re);
+	out.push_back(static_cast<std::uint8_t>(i < 2 ? 0xC0+i : 0xF5+(i-2)));
+}
+
+// '/' (U+002F) encoded in 2, 3 and 4 bytes
+static void gen_u8_overlong(std::default_random_engine& re, std::vector<std::uint8_t>& out) {
+	std::uniform_int_distribution<int> d(2, 4);
+	const int sz = d(re);
+	if (sz == 2) {
+		out.insert(out.end(), {0xC0u, 0xAFu});
+	} else if (sz == 3) {
+		out.insert(out.end(), {0xE0u, 0x80u, 0xAFu});
+	} else {
+		out.insert(out.end(), {0xF0u, 0x80u, 0x80u, 0xAFu});
+	}
+}
+
+// ED A0 80 - ED BF BF
+static void gen_u8_surrogate(std::default_random_engine& re, std::vector<std::uint8_t>& out) {
+	std::uniform_int_distribution<std::uint32_t> d(0xD800u, 0xDFFFu);
+	const std::uint32_t cp = d(re);
+	out.insert(out.end(), {0xEDu, static_cast<std::uint8_t>(0x80u | ((cp>>6) & 0x3Fu)),
+		static_cast<std::uint8_t>(0x80u | (cp & 0x3Fu))});
+}
+
+// A valid 2, 3 or 4-byte sequence missing its last byte
+static void gen_u8_truncated(std::default_random_engine& re, std::vector<std::uint8_t>& out) {
+	static constexpr std::array<std::array<std::uint8_t,3>,3> seqs {{{0xC3u}, {0xE2u, 0x82u}, {0xF0u, 0x9Fu, 0x98u}}};
+	std::uniform_int_distribution<int> d(0, 2);
+	const int i = d(re);
+	out.insert(out.end(), seqs[i].begin(), seqs[i].begin()+i+1);
+}
+
+// 1-8 continuation bytes w/ no leading byte
+static void gen_u8_lone_continuation(std::default_random_engine& re, std::vector<std::uint8_t>& out) {
+	std::uniform_int_distribution<int> n(1, 8);
+	std::uniform_int_distribution<int> b(0x80, 0xBF);
+	for (int i=n(re); i>0; --i) {
+		out.push_back(static_cast<std::uint8_t>(b(re)));
+	}
+}
+
+static constexpr std::array<error_class<std::uint8_t>,6> u8_error_classes {{
+	{"seed", gen_u8_seed},
+	{"bad_leading", gen_u8_bad_leading},
+	{"overlong", gen_u8_overlong},
+	{"surrogate", gen_u8_surrogate},
+	{"truncated", gen_u8_truncated},
+	{"lone_continuation", gen_u8_lone_continuation},
+}};
+
+
+//
+// utf-16 & utf-32
+//
+static void gen_u16_lone_leading(std::default_random_engine& re, std::vector<std::uint16_t>& out) {
+	std::uniform_int_distribution<std::uint32_t> d(0xD800u, 0xDBFFu);
+	out.push_back(static_cast<std::uint16_t>(d(re)));
+}
+static void gen_u16_lone_trailing(std::default_random_engine& re, std::vector<std::uint16_t>& out) {
+	std::uniform_int_distribution<std::uint32_t> d(0xDC00u, 0xDFFFu);
+	out.push_back(static_cast<std::uint16_t>(d(re)));
+}
+static constexpr std::array<error_class<std::uint16_t>,2> u16_error_classes {{
+	{"lone_leading", gen_u16_lone_leading},
+	{"lone_trailing", gen_u16_lone_trailing},
+}};
+
+static void gen_u32_surrogate(std::default_random_engine& re, std::vector<std::uint32_t>& out) {
+	std::uniform_int_distribution<std::uint32_t> d(0xD800u, 0xDFFFu);
+	out.push_back(d(re));
+}
+static void gen_u32_out_of_range(std::default_random_engine& re, std::vector<std::uint32_t>& out) {
+	std::uniform_int_distribution<std::uint32_t> d(0x110000u, 0xFFFFFFFFu);
+	out.push_back(d(re));
+}
+static constexpr std::array<error_class<std::uint32_t>,2> u32_error_classes {{
+	{"surrogate", gen_u32_surrogate},
+	{"out_of_range", gen_u32_out_of_range},
+}};
+
+
+// The number of code units in the valid sequence at the start of s
+static std::size_t seq_size(std::span<const std::uint8_t> s) {
+	return size_utf8_multibyte_seq_from_leading_byte(s[0]);
+}
+static std::size_t seq_size(std::span<const std::uint16_t> s) {
+	return is_valid_utf16_surrogate_pair_leading(s[0]) ? 2 : 1;
+}
+static std::size_t seq_size(std::span<const std::uint32_t>) {
+	return 1;
+}
+
+template<typename T>
+static std::vector<T> make_invalid(std::span<const T> valid, error_generator<T> gen, double p) {
+	std::default_random_engine re(0x5EEDu);
+	std::bernoulli_distribution insert_error(p);
+	std::vector<T> r;
+	r.reserve(valid.size() + valid.size()/2);
+	std::size_t i {0};
+	while (i < valid.size()) {
+		if (insert_error(re)) {
+			gen(re, r);
+		}
+		const std::size_t n = seq_size(valid.subspan(i));
+		r.insert(r.end(), valid.begin()+i, valid.begin()+i+n);
+		i += n;
+	}
+	return r;
+}
+
+// Cached; the data for a benchmark is generated the first time it runs
+template<typename T, std::size_t N>
+static std::span<const T> get_invalid(std::span<const T> valid, const std::array<error_class<T>,N>& classes,
+		std::size_t class_idx, std::size_t density_idx) {
+	static std::array<std::array<std::optional<std::vector<T>>,densities.size()>,N> cache;
+	auto& d = cache[class_idx][density_idx];
+	if (!d) {
+		d = make_invalid(valid, classes[class_idx].gen, densities[density_idx].p);
+	}
+	return *d;
+}
+
+template<typename T>
+static std::vector<T> byteswapped(std::span<const T> s) {
+	std::vector<T> r(s.begin(), s.end());
+	for (T& e : r) {
+		e = reverse_bytes(e);
+	}
+	return r;
+}
+
+
+//
+// Benchmark bodies
+//
+// s_host is s in the byte order of the host, for counting the codepoints, if s is byte-swapped
+template<typename T>
+static void set_throughput_invalid(benchmark::State& state, std::span<const T> s, std::span<const T> s_host) {
+	set_throughput(state, s.size_bytes(), count_codepoints(s_host.data() ? s_host : s));
+}
+
+template<typename It, typename T>
+static void iter_fwd(benchmark::State& state, std::span<const T> s, std::span<const T> s_host = {}) {
+	for (auto _ : state) {
+		std::uint32_t sum {0};
+		It it {s};
+		while (!it.is_finished()) {
+			std::optional<codepoint> cp = it.get_codepoint();
+			sum += cp ? cp->get() : 0xFFFDu;
+			it.go_next();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	set_throughput_invalid(state, s, s_host);
+}
+
+template<typename It, typename T>
+static void iter_rev(benchmark::State& state, std::span<const T> s, std::span<const T> s_host = {}) {
+	It it_end {s};
+	while (!it_end.is_finished()) {
+		it_end.go_next();
+	}
+	for (auto _ : state) {
+		It it = it_end;
+		while (!it.at_start()) {
+			it.go_prev();
+		}
+		benchmark::DoNotOptimize(it);
+	}
+	set_throughput_invalid(state, s, s_host);
+}
+
+template<auto validate, typename T>
+static void validate_all(benchmark::State& state, std::span<const T> s, std::span<const T> s_host = {}) {
+	// The validators stop at the first error; restarting after it is what a caller that wants to count
+	// or skip errors has to do.
+	for (auto _ : state) {
+		std::size_t n_err {0};
+		std::size_t i {0};
+		while (i < s.size()) {
+			i += validate(s.subspan(i));
+			if (i < s.size()) {
+				++n_err;
+				++i;
+			}
+		}
+		benchmark::DoNotOptimize(n_err);
+	}
+	set_throughput_invalid(state, s, s_host);
+}
+
+// As validate_all, for byteswap_and_validate_utf16/32 into a destination the size of the input.  It
+// swaps all of s even past the first error, so restarting it after each error would swap the rest of s
+// again; the rest of the swapped copy is validated in place instead.
+template<auto byteswap_and_validate, auto validate, typename T>
+static void byteswap_and_validate_all(benchmark::State& state, std::span<const T> s, std::span<const T> s_host) {
+	std::vector<T> dest(s.size());
+	for (auto _ : state) {
+		std::size_t n_err {0};
+		std::size_t i = byteswap_and_validate(s, dest);
+		while (i < s.size()) {
+			++n_err;
+			++i;
+			i += validate(std::span<const T>(dest).subspan(i));
+		}
+		benchmark::DoNotOptimize(n_err);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput_invalid(state, s, s_host);
+}
+
+template<typename T>
+static void detect(benchmark::State& state, std::span<const T> s) {
+	const std::span<const std::uint8_t> b {reinterpret_cast<const std::uint8_t*>(s.data()), s.size_bytes()};
+	for (auto _ : state) {
+		detected_encoding r = detect_encoding(b, b.size());
+		benchmark::DoNotOptimize(r);
+	}
+	set_throughput(state, s);
+}
+
+static void u8_lines_index(benchmark::State& state, std::span<const std::uint8_t> s) {
+	for (auto _ : state) {
+		std::vector<utf8_line> lines = index_utf8_lines(s);
+		benchmark::DoNotOptimize(lines);
+	}
+	set_throughput(state, s);
+}
+
+static void u8_scan(benchmark::State& state, std::span<const std::uint8_t> s) {
+	for (auto _ : state) {
+		utf8_scan_report r = scan_utf8(s);
+		benchmark::DoNotOptimize(r);
+	}
+	set_throughput(state, s);
+}
+
+
+//
+// Registration
+//
+template<typename F>
+static void register_invalid(const std::string& prefix, const char* cls, const char* density, F f) {
+	benchmark::RegisterBenchmark((prefix + "_invalid_" + cls + "_" + density).c_str(), f);
+}
+
+static const int invalid_benchmarks_registered = [](){
+	for (std::size_t ci=0; ci<u8_error_classes.size(); ++ci) {
+		if (u8_error_classes[ci].gen == gen_u8_seed && get_seed_errors_utf8().empty()) {
+			continue;  // data/invalid.txt is missing
+		}
+		for (std::size_t di=0; di<densities.size(); ++di) {
+			auto get = [ci, di](){
+				return get_invalid(get_random_codepoints_dataset_2_utf8(), u8_error_classes, ci, di);
+			};
+			const char* cls = u8_error_classes[ci].name;
+			const char* den = densities[di].name;
+			register_invalid("u8_iter_fwd", cls, den, [get](benchmark::State& st){ iter_fwd<utf8_iterator>(st, get()); });
+			register_invalid("u8_iter_rev", cls, den, [get](benchmark::State& st){ iter_rev<utf8_iterator>(st, get()); });
+			register_invalid("u8_iter_fwd_alt", cls, den, [get](benchmark::State& st){ iter_fwd<utf8_iterator_alt>(st, get()); });
+			register_invalid("u8_iter_rev_alt", cls, den, [get](benchmark::State& st){ iter_rev<utf8_iterator_alt>(st, get()); });
+			register_invalid("u8_validate", cls, den, [get](benchmark::State& st){ validate_all<validate_utf8>(st, get()); });
+			register_invalid("u8_lines_index", cls, den, [get](benchmark::State& st){ u8_lines_index(st, get()); });
+			register_invalid("u8_scan", cls, den, [get](benchmark::State& st){ u8_scan(st, get()); });
+			register_invalid("u8_detect", cls, den, [get](benchmark::State& st){ detect(st, get()); });
+		}
+	}
+
+	for (std::size_t ci=0; ci<u16_error_classes.size(); ++ci) {
+		for (std::size_t di=0; di<densities.size(); ++di) {
+			auto get = [ci, di](){
+				return get_invalid(get_random_codepoints_dataset_2_utf16(), u16_error_classes, ci, di);
+			};
+			const char* cls = u16_error_classes[ci].name;
+			const char* den = densities[di].name;
+			register_invalid("u16_iter_fwd", cls, den, [get](benchmark::State& st){ iter_fwd<utf16_iterator>(st, get()); });
+			register_invalid("u16_iter_fwd_alt", cls, den, [get](benchmark::State& st){ iter_fwd<utf16_iterator_alt>(st, get()); });
+			register_invalid("u16_iter_rev", cls, den, [get](benchmark::State& st){ iter_rev<utf16_iterator>(st, get()); });
+			register_invalid("u16_iter_rev_alt", cls, den, [get](benchmark::State& st){ iter_rev<utf16_iterator_alt>(st, get()); });
+			register_invalid("u16_iter_fwd_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint16_t> s = byteswapped(get());
+				iter_fwd<utf16_iterator_swapping>(st, std::span<const std::uint16_t>(s), get());
+			});
+			register_invalid("u16_iter_fwd_alt_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint16_t> s = byteswapped(get());
+				iter_fwd<utf16_iterator_alt_swapping>(st, std::span<const std::uint16_t>(s), get());
+			});
+			register_invalid("u16_iter_rev_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint16_t> s = byteswapped(get());
+				iter_rev<utf16_iterator_swapping>(st, std::span<const std::uint16_t>(s), get());
+			});
+			register_invalid("u16_iter_rev_alt_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint16_t> s = byteswapped(get());
+				iter_rev<utf16_iterator_alt_swapping>(st, std::span<const std::uint16_t>(s), get());
+			});
+			register_invalid("u16_validate", cls, den, [get](benchmark::State& st){ validate_all<validate_utf16>(st, get()); });
+			register_invalid("u16_validate_swapped", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint16_t> s = byteswapped(get());
+				validate_all<validate_utf16_swapped>(st, std::span<const std::uint16_t>(s), get());
+			});
+			register_invalid("u16_byteswap_and_validate", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint16_t> s = byteswapped(get());
+				byteswap_and_validate_all<byteswap_and_validate_utf16,validate_utf16>(st, std::span<const std::uint16_t>(s), get());
+			});
+			register_invalid("u16_detect", cls, den, [get](benchmark::State& st){ detect(st, get()); });
+		}
+	}
+
+	for (std::size_t ci=0; ci<u32_error_classes.size(); ++ci) {
+		for (std::size_t di=0; di<densities.size(); ++di) {
+			auto get = [ci, di](){
+				return get_invalid(get_random_codepoints_dataset_2_utf32(), u32_error_classes, ci, di);
+			};
+			const char* cls = u32_error_classes[ci].name;
+			const char* den = densities[di].name;
+			register_invalid("u32_iter_fwd", cls, den, [get](benchmark::State& st){ iter_fwd<utf32_iterator>(st, get()); });
+			register_invalid("u32_iter_fwd_alt", cls, den, [get](benchmark::State& st){ iter_fwd<utf32_iterator_alt>(st, get()); });
+			register_invalid("u32_iter_rev", cls, den, [get](benchmark::State& st){ iter_rev<utf32_iterator>(st, get()); });
+			register_invalid("u32_iter_rev_alt", cls, den, [get](benchmark::State& st){ iter_rev<utf32_iterator_alt>(st, get()); });
+			register_invalid("u32_iter_fwd_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint32_t> s = byteswapped(get());
+				iter_fwd<utf32_iterator_swapping>(st, std::span<const std::uint32_t>(s), get());
+			});
+			register_invalid("u32_iter_fwd_alt_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint32_t> s = byteswapped(get());
+				iter_fwd<utf32_iterator_alt_swapping>(st, std::span<const std::uint32_t>(s), get());
+			});
+			register_invalid("u32_iter_rev_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint32_t> s = byteswapped(get());
+				iter_rev<utf32_iterator_swapping>(st, std::span<const std::uint32_t>(s), get());
+			});
+			register_invalid("u32_iter_rev_alt_swapping", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint32_t> s = byteswapped(get());
+				iter_rev<utf32_iterator_alt_swapping>(st, std::span<const std::uint32_t>(s), get());
+			});
+			register_invalid("u32_validate", cls, den, [get](benchmark::State& st){ validate_all<validate_utf32>(st, get()); });
+			register_invalid("u32_validate_swapped", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint32_t> s = byteswapped(get());
+				validate_all<validate_utf32_swapped>(st, std::span<const std::uint32_t>(s), get());
+			});
+			register_invalid("u32_byteswap_and_validate", cls, den, [get](benchmark::State& st){
+				std::vector<std::uint32_t> s = byteswapped(get());
+				byteswap_and_validate_all<byteswap_and_validate_utf32,validate_utf32>(st, std::span<const std::uint32_t>(s), get());
+			});
+			register_invalid("u32_detect", cls, den, [get](benchmark::State& st){ detect(st, get()); });
+		}
+	}
+	return 0;
+}();
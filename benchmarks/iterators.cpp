@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+
+//
+// Iterator matrix
+//
+// Every iterator over dataset 2 in its encoding (byte-swapped for the _swapping iterators), three ways:
+//   fwd:                go_next() to the end
+//   rev:                go_prev() from the end to the start
+//   fwd_get_codepoint:  get_codepoint() & go_next() at each position, summing the codepoints
+// Names are <encoding>_iter_<op>[_alt][_swapping]_dataset_2, ex u16_iter_rev_alt_swapping_dataset_2.
+// Every step of the _swapping iterators calls reverse_bytes at least once; the native-order iterators
+// over the same data are the reference.
+
+// Swapped data is passed for the _swapping iterators, which count_codepoints() can't count
+static std::size_t n_codepoints_dataset_2() {
+	return get_random_codepoints_dataset_2_utf32().size();
+}
+
+template<typename It, typename T>
+static void iter_fwd(benchmark::State& state, std::span<const T> s) {
+	for (auto _ : state) {
+		It it {s};
+		while (!it.is_finished()) {
+			it.go_next();
+		}
+		benchmark::DoNotOptimize(it);
+	}
+	set_throughput(state, s.size_bytes(), n_codepoints_dataset_2());
+}
+
+template<typename It, typename T>
+static void iter_rev(benchmark::State& state, std::span<const T> s) {
+	It it_end {s};
+	while (!it_end.is_finished()) {
+		it_end.go_next();
+	}
+	for (auto _ : state) {
+		It it = it_end;
+		while (!it.at_start()) {
+			it.go_prev();
+		}
+		benchmark::DoNotOptimize(it);
+	}
+	set_throughput(state, s.size_bytes(), n_codepoints_dataset_2());
+}
+
+template<typename It, typename T>
+static void iter_fwd_get_codepoint(benchmark::State& state, std::span<const T> s) {
+	for (auto _ : state) {
+		std::uint32_t sum {0};
+		It it {s};
+		while (!it.is_finished()) {
+			std::optional<codepoint> cp = it.get_codepoint();
+			sum += cp ? cp->get() : 0u;
+			it.go_next();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	set_throughput(state, s.size_bytes(), n_codepoints_dataset_2());
+}
+
+template<typename It, typename T>
+static void register_iterator(const std::string& enc, const std::string& variant, std::span<const T> (*get_data)()) {
+	const std::string suffix = variant + "_dataset_2";
+	benchmark::RegisterBenchmark((enc + "_iter_fwd" + suffix).c_str(), [get_data](benchmark::State& st){
+		iter_fwd<It>(st, get_data());
+	});
+	benchmark::RegisterBenchmark((enc + "_iter_rev" + suffix).c_str(), [get_data](benchmark::State& st){
+		iter_rev<It>(st, get_data());
+	});
+	benchmark::RegisterBenchmark((enc + "_iter_fwd_get_codepoint" + suffix).c_str(), [get_data](benchmark::State& st){
+		iter_fwd_get_codepoint<It>(st, get_data());
+	});
+}
+
+static const int iterator_benchmarks_registered = [](){
+	register_iterator<utf8_iterator>("u8", "", get_random_codepoints_dataset_2_utf8);
+	register_iterator<utf8_iterator_alt>("u8", "_alt", get_random_codepoints_dataset_2_utf8);
+
+	register_iterator<utf16_iterator>("u16", "", get_random_codepoints_dataset_2_utf16);
+	register_iterator<utf16_iterator_alt>("u16", "_alt", get_random_codepoints_dataset_2_utf16);
+	register_iterator<utf16_iterator_swapping>("u16", "_swapping", get_random_codepoints_dataset_2_utf16_swapped);
+	register_iterator<utf16_iterator_alt_swapping>("u16", "_alt_swapping", get_random_codepoints_dataset_2_utf16_swapped);
+
+	register_iterator<utf32_iterator>("u32", "", get_random_codepoints_dataset_2_utf32);
+	register_iterator<utf32_iterator_alt>("u32", "_alt", get_random_codepoints_dataset_2_utf32);
+	register_iterator<utf32_iterator_swapping>("u32", "_swapping", get_random_codepoints_dataset_2_utf32_swapped);
+	register_iterator<utf32_iterator_alt_swapping>("u32", "_alt_swapping", get_random_codepoints_dataset_2_utf32_swapped);
+	return 0;
+}();
@@ -1,4 +1,85 @@
 #include <benchmark/benchmark.h>
+#include "regression.h"
+#include "perf_counters.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
 
-BENCHMARK_MAIN();
 
+// Google Benchmark's flags, plus:
+//   --utflib_baseline=<json>       compare w/ a baseline written by an earlier run w/
+//                                  --benchmark_out=<json> --benchmark_out_format=json, print a table
+//                                  and exit w/ 1 if any benchmark regressed
+//   --utflib_tolerance=<pct>       allowed slowdown, in percent, for benchmarks not matched by a rule
+//                                  (default 10)
+//   --utflib_tolerances=<file>     per-benchmark tolerances (see tolerances.txt)
+//   --utflib_perf_counters         report hardware counters (Linux; see perf_counters.h)
+// Baselines are specific to a machine & build, so none are committed.  Ex:
+//   benchmarks --benchmark_repetitions=5 --benchmark_out=base.json --benchmark_out_format=json
+//   (change something)
+//   benchmarks --benchmark_repetitions=5 --utflib_baseline=base.json --utflib_tolerances=../benchmarks/tolerances.txt
+
+static bool get_flag(std::string_view arg, std::string_view flag, std::string& value) {
+	if (!arg.starts_with(flag) || arg.size() <= flag.size() || arg[flag.size()] != '=') {
+		return false;
+	}
+	value = std::string(arg.substr(flag.size()+1));
+	return true;
+}
+
+int main(int argc, char** argv) {
+	std::string baseline_file;
+	std::string tolerances_file;
+	std::string default_tolerance {"10"};
+	bool perf_counters {false};
+	std::vector<char*> args;
+	for (int i=0; i<argc; ++i) {
+		if (std::string_view(argv[i]) == "--utflib_perf_counters") {
+			perf_counters = true;
+		} else if (!get_flag(argv[i], "--utflib_baseline", baseline_file)
+				&& !get_flag(argv[i], "--utflib_tolerances", tolerances_file)
+				&& !get_flag(argv[i], "--utflib_tolerance", default_tolerance)) {
+			args.push_back(argv[i]);
+		}
+	}
+	int n_args = static_cast<int>(args.size());
+	args.push_back(nullptr);
+
+	benchmark::Initialize(&n_args, args.data());
+	if (benchmark::ReportUnrecognizedArguments(n_args, args.data())) {
+		return 1;
+	}
+	if (perf_counters) {
+		enable_perf_counters();
+	}
+
+	if (baseline_file.empty()) {
+		benchmark::RunSpecifiedBenchmarks();
+		benchmark::Shutdown();
+		return 0;
+	}
+
+	auto baseline = read_benchmark_json(baseline_file);
+	if (!baseline) {
+		std::fprintf(stderr, "Could not read baseline %s\n", baseline_file.c_str());
+		return 1;
+	}
+	std::vector<tolerance_rule> rules;
+	if (!tolerances_file.empty()) {
+		auto r = read_tolerances(tolerances_file);
+		if (!r) {
+			std::fprintf(stderr, "Could not read tolerances %s\n", tolerances_file.c_str());
+			return 1;
+		}
+		rules = std::move(*r);
+	}
+
+	collecting_reporter reporter;
+	benchmark::RunSpecifiedBenchmarks(&reporter);
+	benchmark::Shutdown();
+	const std::size_t n_regressed = print_regression_table(*baseline, reporter.get(), rules,
+		std::strtod(default_tolerance.c_str(), nullptr));
+	return (n_regressed > 0) ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+#include "perf_counters.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+enum counter {cycles, instructions, branch_misses, l1d_misses, n_counters};
+
+struct perf_state {
+	bool enabled {false};
+	std::array<int,n_counters> fd {-1, -1, -1, -1};
+	std::array<double,n_counters> last {};  // At the end of the previous run
+};
+perf_state g_perf;
+}
+
+#ifdef __linux__
+static int open_counter(std::uint32_t type, std::uint64_t config) {
+	perf_event_attr attr {};
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// The count so far, scaled up for the time the counter was not scheduled
+static double read_counter(int fd) {
+	struct {
+		std::uint64_t value;
+		std::uint64_t time_enabled;
+		std::uint64_t time_running;
+	} r {};
+	if (fd < 0 || read(fd, &r, sizeof(r)) != static_cast<ssize_t>(sizeof(r)) || r.time_running == 0) {
+		return 0.0;
+	}
+	return static_cast<double>(r.value) * static_cast<double>(r.time_enabled) / static_cast<double>(r.time_running);
+}
+
+bool enable_perf_counters() {
+	constexpr std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+		| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	g_perf.fd[cycles] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	const int err = errno;
+	g_perf.fd[instructions] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	g_perf.fd[branch_misses] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+	g_perf.fd[l1d_misses] = open_counter(PERF_TYPE_HW_CACHE, l1d_read_miss);
+
+	g_perf.enabled = false;
+	for (int i=0; i<n_counters; ++i) {
+		g_perf.enabled = g_perf.enabled || (g_perf.fd[i] >= 0);
+		g_perf.last[i] = read_counter(g_perf.fd[i]);
+	}
+	if (!g_perf.enabled) {
+		std::fprintf(stderr, "perf_event_open failed (%s); no hardware counters will be reported\n", std::strerror(err));
+	}
+	return g_perf.enabled;
+}
+#else
+static double read_counter(int) {
+	return 0.0;
+}
+
+bool enable_perf_counters() {
+	std::fprintf(stderr, "Hardware counters are only supported on Linux\n");
+	return false;
+}
+#endif
+
+void report_perf_counters(benchmark::State& state, std::size_t n_bytes) {
+	if (!g_perf.enabled || state.iterations() == 0) {
+		return;
+	}
+	std::array<double,n_counters> d {};
+	for (int i=0; i<n_counters; ++i) {
+		d[i] = read_counter(g_perf.fd[i]) - g_perf.last[i];
+	}
+
+	if (g_perf.fd[cycles] >= 0 && g_perf.fd[instructions] >= 0 && d[cycles] > 0) {
+		state.counters["ipc"] = d[instructions] / d[cycles];
+	}
+	const double total_bytes = static_cast<double>(state.iterations()) * static_cast<double>(n_bytes);
+	if (total_bytes > 0) {
+		const std::array<const char*,n_counters> names {"cycles_per_byte", "instructions_per_byte",
+			"branch_misses_per_byte", "l1d_misses_per_byte"};
+		for (int i=0; i<n_counters; ++i) {
+			if (g_perf.fd[i] >= 0) {
+				state.counters[names[i]] = d[i] / total_bytes;
+			}
+		}
+	}
+
+	// Read again so that the counts of the next run don't include this
+	for (int i=0; i<n_counters; ++i) {
+		g_perf.last[i] = read_counter(g_perf.fd[i]);
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+
+//
+// Hardware performance counters
+//
+// w/ --utflib_perf_counters (see main.cpp), every benchmark also reports, from Linux perf_event:
+//   ipc                      instructions per cycle
+//   cycles_per_byte          of input; the bytes are those given to set_throughput()
+//   instructions_per_byte
+//   branch_misses_per_byte
+//   l1d_misses_per_byte      L1 data cache read misses
+// Counts are of user-space code in this thread, scaled if the kernel multiplexed the counters.  There
+// is no hook at the start of a benchmark's timing loop, so a run's counts are taken from the end of the
+// previous run to its own call to set_throughput(), which includes its setup.  Google Benchmark reports
+// the last, longest run of each benchmark, where that setup is negligible; results from benchmarks
+// that pause timing are not meaningful.
+
+// Opens the counters.  False, w/ a message on stderr, if none could be opened (ex not Linux, a high
+// kernel.perf_event_paranoid, or a VM w/o a PMU); some counters may be missing even if true.
+bool enable_perf_counters();
+
+// Adds the counters above to state for the run that just finished; does nothing unless
+// enable_perf_counters() succeeded.  Called by set_throughput().
+void report_perf_counters(benchmark::State& state, std::size_t n_bytes);
@@ -0,0 +1,363 @@
+#include "regression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+
+
+//
+// Times
+//
+void benchmark_times::add(const std::string& run_name, bool is_aggregate, const std::string& aggregate_name, double cpu_ns) {
+	if (!is_aggregate) {
+		m_iterations[run_name].push_back(cpu_ns);
+	} else if (aggregate_name == "median") {
+		m_medians[run_name] = cpu_ns;
+	}
+}
+
+std::map<std::string,double> benchmark_times::get() const {
+	std::map<std::string,double> r = m_medians;
+	for (auto [name, v] : m_iterations) {
+		std::sort(v.begin(), v.end());
+		const std::size_t n = v.size();
+		r[name] = (n%2 == 1) ? v[n/2] : (v[n/2-1] + v[n/2])/2;
+	}
+	return r;
+}
+
+void collecting_reporter::ReportRuns(const std::vector<Run>& reports) {
+	for (const Run& run : reports) {
+		if (run.error_occurred) {
+			continue;
+		}
+		const double ns = run.GetAdjustedCPUTime() * 1e9 / benchmark::GetTimeUnitMultiplier(run.time_unit);
+		m_times.add(run.run_name.str(), run.run_type == Run::RT_Aggregate, run.aggregate_name, ns);
+	}
+	ConsoleReporter::ReportRuns(reports);
+}
+
+std::map<std::string,double> collecting_reporter::get() const {
+	return m_times.get();
+}
+
+
+//
+// json
+//
+// Just enough of a parser for the files Google Benchmark writes.  Those may contain NaN and Infinity,
+// which are not json, as numbers.
+struct json_value {
+	enum class kind {null, boolean, number, string, array, object};
+	kind k {kind::null};
+	bool b {};
+	double num {};
+	std::string str;
+	std::vector<json_value> elems;  // array elements, or object values
+	std::vector<std::string> keys;  // object keys, parallel to elems
+
+	const json_value* find(std::string_view key) const {
+		for (std::size_t i=0; i<keys.size(); ++i) {
+			if (keys[i] == key) {
+				return &elems[i];
+			}
+		}
+		return nullptr;
+	}
+};
+
+class json_parser {
+public:
+	explicit json_parser(std::string_view s) : m_s(s) {}
+
+	std::optional<json_value> parse() {
+		std::optional<json_value> v = value();
+		skip_ws();
+		if (!v || m_i != m_s.size()) {
+			return std::nullopt;
+		}
+		return v;
+	}
+private:
+	void skip_ws() {
+		while (m_i < m_s.size() && (m_s[m_i]==' ' || m_s[m_i]=='\n' || m_s[m_i]=='\r' || m_s[m_i]=='\t')) {
+			++m_i;
+		}
+	}
+	bool consume(std::string_view lit) {
+		if (m_s.substr(m_i, lit.size()) != lit) {
+			return false;
+		}
+		m_i += lit.size();
+		return true;
+	}
+
+	std::optional<json_value> value() {
+		skip_ws();
+		if (m_i == m_s.size()) {
+			return std::nullopt;
+		}
+		json_value v;
+		const char c = m_s[m_i];
+		if (c == '{') {
+			return object();
+		} else if (c == '[') {
+			return array();
+		} else if (c == '"') {
+			std::optional<std::string> s = string();
+			if (!s) {
+				return std::nullopt;
+			}
+			v.k = json_value::kind::string;
+			v.str = std::move(*s);
+		} else if (consume("true")) {
+			v.k = json_value::kind::boolean;
+			v.b = true;
+		} else if (consume("false")) {
+			v.k = json_value::kind::boolean;
+		} else if (consume("null")) {
+			v.k = json_value::kind::null;
+		} else {
+			// strtod also accepts NaN & Infinity
+			const std::string rest(m_s.substr(m_i, 64));
+			char* end {};
+			v.num = std::strtod(rest.c_str(), &end);
+			if (end == rest.c_str()) {
+				return std::nullopt;
+			}
+			v.k = json_value::kind::number;
+			m_i += end - rest.c_str();
+		}
+		return v;
+	}
+
+	std::optional<std::string> string() {
+		if (!consume("\"")) {
+			return std::nullopt;
+		}
+		std::string r;
+		while (m_i < m_s.size() && m_s[m_i] != '"') {
+			char c = m_s[m_i++];
+			if (c == '\\') {
+				if (m_i == m_s.size()) {
+					return std::nullopt;
+				}
+				c = m_s[m_i++];
+				switch (c) {
+					case 'n': c = '\n'; break;
+					case 't': c = '\t'; break;
+					case 'r': c = '\r'; break;
+					case 'b': c = '\b'; break;
+					case 'f': c = '\f'; break;
+					case 'u': {
+						// Benchmark names are ascii; anything else is replaced
+						if (m_i+4 > m_s.size()) {
+							return std::nullopt;
+						}
+						const unsigned long v = std::strtoul(std::string(m_s.substr(m_i, 4)).c_str(), nullptr, 16);
+						c = (v <= 0x7Fu) ? static_cast<char>(v) : '?';
+						m_i += 4;
+						break;
+					}
+					default: break;  // \" \\ \/
+				}
+			}
+			r.push_back(c);
+		}
+		if (!consume("\"")) {
+			return std::nullopt;
+		}
+		return r;
+	}
+
+	std::optional<json_value> array() {
+		json_value v;
+		v.k = json_value::kind::array;
+		consume("[");
+		skip_ws();
+		if (consume("]")) {
+			return v;
+		}
+		while (true) {
+			std::optional<json_value> e = value();
+			if (!e) {
+				return std::nullopt;
+			}
+			v.elems.push_back(std::move(*e));
+			skip_ws();
+			if (consume("]")) {
+				return v;
+			}
+			if (!consume(",")) {
+				return std::nullopt;
+			}
+		}
+	}
+
+	std::optional<json_value> object() {
+		json_value v;
+		v.k = json_value::kind::object;
+		consume("{");
+		skip_ws();
+		if (consume("}")) {
+			return v;
+		}
+		while (true) {
+			skip_ws();
+			std::optional<std::string> key = string();
+			skip_ws();
+			if (!key || !consume(":")) {
+				return std::nullopt;
+			}
+			std::optional<json_value> e = value();
+			if (!e) {
+				return std::nullopt;
+			}
+			v.keys.push_back(std::move(*key));
+			v.elems.push_back(std::move(*e));
+			skip_ws();
+			if (consume("}")) {
+				return v;
+			}
+			if (!consume(",")) {
+				return std::nullopt;
+			}
+		}
+	}
+
+	std::string_view m_s;
+	std::size_t m_i {0};
+};
+
+static double ns_per_unit(const std::string& unit) {
+	if (unit == "us") { return 1e3; }
+	if (unit == "ms") { return 1e6; }
+	if (unit == "s") { return 1e9; }
+	return 1.0;
+}
+
+std::optional<std::map<std::string,double>> read_benchmark_json(const std::filesystem::path& fp) {
+	std::ifstream f(fp, std::ios::binary);
+	if (!f) {
+		return std::nullopt;
+	}
+	const std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	std::optional<json_value> root = json_parser(text).parse();
+	if (!root || root->k != json_value::kind::object) {
+		return std::nullopt;
+	}
+	const json_value* benchmarks = root->find("benchmarks");
+	if (!benchmarks || benchmarks->k != json_value::kind::array) {
+		return std::nullopt;
+	}
+
+	benchmark_times times;
+	for (const json_value& b : benchmarks->elems) {
+		const json_value* name = b.find("run_name");
+		if (!name) {
+			name = b.find("name");
+		}
+		const json_value* cpu_time = b.find("cpu_time");
+		if (!name || !cpu_time || cpu_time->k != json_value::kind::number) {
+			continue;  // Ex, a benchmark that failed w/ SkipWithError
+		}
+		const json_value* run_type = b.find("run_type");
+		const json_value* aggregate_name = b.find("aggregate_name");
+		const json_value* time_unit = b.find("time_unit");
+		const bool is_aggregate = run_type && run_type->str == "aggregate";
+		times.add(name->str, is_aggregate, aggregate_name ? aggregate_name->str : std::string(),
+			cpu_time->num * ns_per_unit(time_unit ? time_unit->str : std::string("ns")));
+	}
+	return times.get();
+}
+
+
+//
+// Tolerances & the table
+//
+std::optional<std::vector<tolerance_rule>> read_tolerances(const std::filesystem::path& fp) {
+	std::ifstream f(fp);
+	if (!f) {
+		return std::nullopt;
+	}
+	std::vector<tolerance_rule> rules;
+	std::string line;
+	while (std::getline(f, line)) {
+		std::istringstream ss(line);
+		tolerance_rule r;
+		if (!(ss >> r.pattern) || r.pattern[0] == '#') {
+			continue;
+		}
+		if (!(ss >> r.pct)) {
+			return std::nullopt;
+		}
+		try {
+			r.re = std::regex(r.pattern);
+		} catch (const std::regex_error&) {
+			return std::nullopt;
+		}
+		rules.push_back(std::move(r));
+	}
+	return rules;
+}
+
+static double get_tolerance(const std::string& name, const std::vector<tolerance_rule>& rules, double default_pct) {
+	for (const auto& r : rules) {
+		if (std::regex_match(name, r.re)) {
+			return r.pct;
+		}
+	}
+	return default_pct;
+}
+
+std::size_t print_regression_table(const std::map<std::string,double>& baseline,
+		const std::map<std::string,double>& current, const std::vector<tolerance_rule>& rules, double default_pct) {
+	std::map<std::string,bool> names;
+	for (const auto& e : baseline) {
+		names[e.first];
+	}
+	for (const auto& e : current) {
+		names[e.first];
+	}
+	std::size_t w {9};
+	for (const auto& e : names) {
+		w = std::max(w, e.first.size());
+	}
+
+	std::printf("\n%-*s %14s %14s %9s %7s  %s\n", static_cast<int>(w), "Benchmark", "Baseline ns", "Current ns",
+		"Change", "Tol", "Status");
+	std::printf("%s\n", std::string(w + 14+14+9+7 + 6 + 10, '-').c_str());
+	std::size_t n_regressed {0};
+	std::size_t n_improved {0};
+	for (const auto& e : names) {
+		const std::string& name = e.first;
+		auto b = baseline.find(name);
+		auto c = current.find(name);
+		if (b == baseline.end()) {
+			std::printf("%-*s %14s %14.0f %9s %7s  %s\n", static_cast<int>(w), name.c_str(), "-", c->second, "", "", "new");
+			continue;
+		}
+		if (c == current.end()) {
+			// Not run this time (filtered out or failed); not a regression
+			continue;
+		}
+		const double tol = get_tolerance(name, rules, default_pct);
+		const double change = 100.0*(c->second - b->second)/b->second;
+		const char* status = "ok";
+		if (change > tol) {
+			status = "REGRESSION";
+			++n_regressed;
+		} else if (change < -tol) {
+			status = "faster";
+			++n_improved;
+		}
+		std::printf("%-*s %14.0f %14.0f %+8.1f%% %6.1f%%  %s\n", static_cast<int>(w), name.c_str(), b->second,
+			c->second, change, tol, status);
+	}
+	std::printf("\n%zu regressed, %zu faster beyond tolerance\n", n_regressed, n_improved);
+	return n_regressed;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+
+//
+// Regression checking
+//
+// Compares the cpu time of each benchmark in this run w/ that in a baseline file written by an earlier
+// run w/ --benchmark_out=<file> --benchmark_out_format=json (see main.cpp for the flags).  A benchmark's
+// time is the median of its repetitions, or the reported median aggregate when only aggregates were
+// reported, in ns.
+
+// Reduces the runs of each benchmark to one time
+class benchmark_times {
+public:
+	void add(const std::string& run_name, bool is_aggregate, const std::string& aggregate_name, double cpu_ns);
+	std::map<std::string,double> get() const;
+private:
+	std::map<std::string,std::vector<double>> m_iterations;
+	std::map<std::string,double> m_medians;
+};
+
+// The usual console output, plus the times of every run
+class collecting_reporter : public benchmark::ConsoleReporter {
+public:
+	void ReportRuns(const std::vector<Run>& reports) override;
+	std::map<std::string,double> get() const;
+private:
+	benchmark_times m_times;
+};
+
+// std::nullopt if the file can't be read or isn't Google Benchmark json
+std::optional<std::map<std::string,double>> read_benchmark_json(const std::filesystem::path& fp);
+
+// Lines of <regex> <percent>; blank lines and lines beginning w/ # are ignored.  std::nullopt if the
+// file can't be read or a line is malformed.
+struct tolerance_rule {
+	std::string pattern;
+	std::regex re;
+	double pct {};
+};
+std::optional<std::vector<tolerance_rule>> read_tolerances(const std::filesystem::path& fp);
+
+// Prints a table of every benchmark in either map to stdout and returns the number of regressions:
+// benchmarks slower than the baseline by more than the tolerance of the first rule whose regex matches
+// the whole name, or default_pct.
+std::size_t print_regression_table(const std::map<std::string,double>& baseline,
+	const std::map<std::string,double>& current, const std::vector<tolerance_rule>& rules, double default_pct);
@@ -0,0 +1,241 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/utflib.h"
+#include "utflib/low_level.h"
+#include "utflib/iterators.h"
+#include "utflib/validate.h"
+#include "utflib/encoders.h"
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+//
+// Short strings
+//
+// Latency, rather than throughput, for strings of 8 to 200 bytes, where the fixed cost of a call
+// (iterator construction, std::optional, function call) outweighs the per-byte cost.  Each benchmark
+// runs a routine on a pool of 256 strings of about the same length, cut at codepoint boundaries from a
+// generated corpus at seeded random offsets, so that no one string is learned by the branch predictor.
+// The corpus is <model>_262144.  If UTFLIB_CORPUS_MAX_SIZE left that out, the largest smaller one
+// generated for the model is used instead, and lengths it can't supply are skipped; either is noted on
+// stderr at startup, as is a model w/ no corpus at all.
+//
+// Names are <encoding>_<operation>[_<variant>]_short_<model>_<length>, ex u8_validate_short_cjk_32.
+// Besides the usual time per iteration (a batch of 16 calls), each reports percentiles over the batches
+// of the mean time per call in a batch, as counters p50_batch16_ns, p90_batch16_ns, p99_batch16_ns and
+// p999_batch16_ns.  These are not percentiles of single calls:  one slow call in a batch is averaged w/
+// the other 15, so the upper percentiles understate the tail.  A single call is too short to time
+// directly w/ steady_clock, whose own cost is of the same order.  Every percentile includes 1/16 of the
+// cost of reading the clock.
+//
+// The library has no runtime cpu dispatch (SSE2 is chosen at compile time; see simd.h), so there is no
+// dispatch indirection to measure as such.  The _fnptr variant calls validate_utf8 through a function
+// pointer the compiler can't see through, which is what a dispatched entry point would cost.
+
+namespace {
+constexpr std::size_t pool_size {256};
+constexpr std::size_t batch_size {16};
+constexpr std::size_t max_samples {1u<<20};
+
+struct short_string_pool {
+	std::vector<std::span<const std::uint8_t>> s;
+	std::size_t n_bytes {};  // Totals over the pool
+	std::size_t n_cp {};
+};
+
+// Records the time of each batch and reports the percentiles of the mean time per call in a batch
+class latency_recorder {
+public:
+	latency_recorder() {
+		m_ns.reserve(max_samples);
+	}
+	void add(std::chrono::steady_clock::duration d) {
+		if (m_ns.size() < max_samples) {
+			m_ns.push_back(std::chrono::duration<double,std::nano>(d).count() / batch_size);
+		}
+	}
+	void report(benchmark::State& state) {
+		if (m_ns.empty()) {
+			return;
+		}
+		std::sort(m_ns.begin(), m_ns.end());
+		auto pct = [this](double p){
+			return m_ns[std::min(m_ns.size()-1, static_cast<std::size_t>(p*m_ns.size()))];
+		};
+		state.counters["p50_batch16_ns"] = pct(0.5);
+		state.counters["p90_batch16_ns"] = pct(0.9);
+		state.counters["p99_batch16_ns"] = pct(0.99);
+		state.counters["p999_batch16_ns"] = pct(0.999);
+	}
+private:
+	std::vector<double> m_ns;
+};
+}
+
+static const short_string_pool& get_short_strings(const std::string& corpus, std::size_t len) {
+	static std::map<std::pair<std::string,std::size_t>,short_string_pool> cache;
+	auto it = cache.find({corpus, len});
+	if (it != cache.end()) {
+		return it->second;
+	}
+
+	std::span<const std::uint8_t> c = get_corpus(corpus);
+	short_string_pool p;
+	std::default_random_engine re(static_cast<std::uint32_t>(len));
+	std::uniform_int_distribution<std::size_t> rd_offset(0, c.size()-len);
+	for (std::size_t i=0; i<pool_size; ++i) {
+		std::size_t b = rd_offset(re);
+		std::size_t e = b + len;
+		while (b < e && is_utf8_trailing_byte(c[b])) {
+			++b;
+		}
+		while (e > b && e < c.size() && is_utf8_trailing_byte(c[e])) {
+			--e;
+		}
+		p.s.push_back(c.subspan(b, e-b));
+		p.n_bytes += e-b;
+		p.n_cp += count_codepoints(p.s.back());
+	}
+	return cache.emplace(std::make_pair(corpus, len), std::move(p)).first->second;
+}
+
+// Runs f on batch_size strings per iteration, cycling through the pool
+template<typename F>
+static void run_short(benchmark::State& state, const std::string& corpus, std::size_t len, F f) {
+	const short_string_pool& p = get_short_strings(corpus, len);
+	latency_recorder rec;
+	std::size_t i {0};
+	for (auto _ : state) {
+		const auto t0 = std::chrono::steady_clock::now();
+		for (std::size_t j=0; j<batch_size; ++j) {
+			f(p.s[i]);
+			i = (i+1) % pool_size;
+		}
+		rec.add(std::chrono::steady_clock::now() - t0);
+	}
+	rec.report(state);
+	set_throughput(state, p.n_bytes*batch_size/pool_size, p.n_cp*batch_size/pool_size);
+}
+
+
+//
+// Operations
+//
+static void u8_validate_short(benchmark::State& state, const std::string& corpus, std::size_t len) {
+	run_short(state, corpus, len, [](std::span<const std::uint8_t> s){
+		std::size_t n = validate_utf8(s);
+		benchmark::DoNotOptimize(n);
+	});
+}
+
+static void u8_validate_fnptr_short(benchmark::State& state, const std::string& corpus, std::size_t len) {
+	std::size_t (*f)(std::span<const std::uint8_t>) = validate_utf8;
+	run_short(state, corpus, len, [&f](std::span<const std::uint8_t> s){
+		benchmark::DoNotOptimize(f);  // Ex, selected at startup from the cpu's features
+		std::size_t n = f(s);
+		benchmark::DoNotOptimize(n);
+	});
+}
+
+static void u8_count_short(benchmark::State& state, const std::string& corpus, std::size_t len) {
+	run_short(state, corpus, len, [](std::span<const std::uint8_t> s){
+		std::size_t n {0};
+		for (utf8_iterator_alt it {s}; !it.is_finished(); it.go_next()) {
+			++n;
+		}
+		benchmark::DoNotOptimize(n);
+	});
+}
+
+static void u8_to_u16_short(benchmark::State& state, const std::string& corpus, std::size_t len) {
+	std::vector<std::uint16_t> dest(2*len);
+	run_short(state, corpus, len, [&dest](std::span<const std::uint8_t> s){
+		std::uint16_t* p = dest.data();
+		for (utf8_iterator_alt it {s}; !it.is_finished(); it.go_next()) {
+			std::optional<codepoint> cp = it.get_codepoint();
+			p = encode_utf16(cp ? *cp : *codepoint::to_codepoint(0xFFFDu), p);
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::ClobberMemory();
+	});
+}
+
+static void u8_to_u32_short(benchmark::State& state, const std::string& corpus, std::size_t len) {
+	std::vector<std::uint32_t> dest(len);
+	run_short(state, corpus, len, [&dest](std::span<const std::uint8_t> s){
+		std::uint32_t* p = dest.data();
+		for (utf8_iterator_alt it {s}; !it.is_finished(); it.go_next()) {
+			std::optional<codepoint> cp = it.get_codepoint();
+			*p++ = cp ? cp->get() : 0xFFFDu;
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::ClobberMemory();
+	});
+}
+
+// The name of the largest corpus of model no bigger than 262144 bytes, or std::nullopt if there is none
+static std::optional<std::string> short_string_corpus(const std::string& model) {
+	std::optional<std::string> best;
+	std::size_t best_size {0};
+	for (const std::string& name : get_corpus_names()) {
+		if (!name.starts_with(model + "_")) {
+			continue;
+		}
+		const std::string size_str = name.substr(model.size()+1);
+		if (size_str.empty() || !std::ranges::all_of(size_str, [](char c){ return c >= '0' && c <= '9'; })) {
+			continue;
+		}
+		const std::size_t size = std::stoull(size_str);
+		if (size <= 262144 && size > best_size && !get_corpus(name).empty()) {
+			best = name;
+			best_size = size;
+		}
+	}
+	return best;
+}
+
+static const int short_string_benchmarks_registered = [](){
+	using op = void(*)(benchmark::State&, const std::string&, std::size_t);
+	const std::pair<const char*,op> ops[] {
+		{"u8_validate", u8_validate_short},
+		{"u8_validate_fnptr", u8_validate_fnptr_short},
+		{"u8_count", u8_count_short},
+		{"u8_to_u16", u8_to_u16_short},
+		{"u8_to_u32", u8_to_u32_short},
+	};
+	for (const char* model : {"english", "cyrillic", "cjk", "emoji_chat", "mixed_logs"}) {
+		const std::optional<std::string> corpus = short_string_corpus(model);
+		if (!corpus) {
+			std::fprintf(stderr, "warning:  no %s corpus was generated; skipping the %s short-string benchmarks\n",
+				model, model);
+			continue;
+		}
+		const std::size_t corpus_size = get_corpus(*corpus).size();
+		if (*corpus != std::string(model) + "_262144") {
+			std::fprintf(stderr, "warning:  %s_262144 was not generated (see UTFLIB_CORPUS_MAX_SIZE); the %s "
+				"short strings are cut from %s\n", model, model, corpus->c_str());
+		}
+		for (std::size_t len : {8, 16, 32, 64, 128, 200}) {
+			if (len > corpus_size) {
+				std::fprintf(stderr, "warning:  %s is too small for the %s short strings of length %zu; skipped\n",
+					corpus->c_str(), model, len);
+				continue;
+			}
+			for (const auto& [name, f] : ops) {
+				const std::string bm_name = std::string(name) + "_short_" + model + "_" + std::to_string(len);
+				benchmark::RegisterBenchmark(bm_name.c_str(), f, *corpus, len);
+			}
+		}
+	}
+	return 0;
+}();
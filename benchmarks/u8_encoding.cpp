@@ -17,7 +17,7 @@
 // the loop that the user would manually write using .get().  Is get_all() the faster approach?
 
 // Calling .get() in a loop manually written by the user
-static void random_utf32_to_utf8_generator_in_loop_calling_get(benchmark::State& state) {
+static void u32_to_u8_generator_get_loop_dataset_2(benchmark::State& state) {
 	// 2025/02/09:  602338 ns       530134 ns         1120
 	std::vector<std::uint8_t> dest;
 	dest.reserve(get_random_codepoints_dataset_2_utf8().size());
@@ -36,11 +36,12 @@ static void random_utf32_to_utf8_generator_in_loop_calling_get(benchmark::State&
 		benchmark::DoNotOptimize(oit);
 		benchmark::DoNotOptimize(dest);
 	}
+	set_throughput(state, s);
 }
-BENCHMARK(random_utf32_to_utf8_generator_in_loop_calling_get);
+BENCHMARK(u32_to_u8_generator_get_loop_dataset_2);
 
 // Using .get_all()
-static void random_utf32_to_utf8_generator_get_all_no_loop(benchmark::State& state) {
+static void u32_to_u8_generator_get_all_dataset_2(benchmark::State& state) {
 	// 2025/02/09:  507238 ns       498767 ns         1723
 	std::vector<std::uint8_t> dest;
 	dest.reserve(get_random_codepoints_dataset_2_utf8().size());
@@ -56,5 +57,156 @@ static void random_utf32_to_utf8_generator_get_all_no_loop(benchmark::State& sta
 		benchmark::DoNotOptimize(oit);
 		benchmark::DoNotOptimize(dest);
 	}
+	set_throughput(state, s);
 }
-BENCHMARK(random_utf32_to_utf8_generator_get_all_no_loop);
+BENCHMARK(u32_to_u8_generator_get_all_dataset_2);
+
+
+//
+// Writing to a raw pointer
+//
+// The benchmarks above write through a back_insert_iterator, which checks capacity for every byte.  Here
+// the destination is sized up front:  get_all() w/ a raw pointer writes the bytes one at a time;
+// encode_utf8 writes each sequence w/ one 4-byte store, which needs 3 bytes of slack at the end of the
+// buffer; the end-pointer overload of encode_utf8 needs no slack.
+
+static void u32_to_u8_generator_get_all_raw_pointer_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	std::vector<std::uint8_t> dest(get_random_codepoints_dataset_2_utf8().size());
+	for (auto _ : state) {
+		std::uint8_t* p = dest.data();
+		for (std::uint32_t curr_val : s) {
+			std::optional<codepoint> ocp = codepoint::to_codepoint(curr_val);
+			utf8_generator g(*ocp);
+			p = g.get_all(p);
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u8_generator_get_all_raw_pointer_dataset_2);
+
+static void u32_to_u8_encode_utf8_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	std::vector<std::uint8_t> dest(get_random_codepoints_dataset_2_utf8().size() + 3);
+	for (auto _ : state) {
+		std::uint8_t* p = dest.data();
+		for (std::uint32_t curr_val : s) {
+			std::optional<codepoint> ocp = codepoint::to_codepoint(curr_val);
+			p = encode_utf8(*ocp, p);
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u8_encode_utf8_dataset_2);
+
+static void u32_to_u8_encode_utf8_end_pointer_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	std::vector<std::uint8_t> dest(get_random_codepoints_dataset_2_utf8().size());
+	for (auto _ : state) {
+		std::uint8_t* p = dest.data();
+		std::uint8_t* const p_end = dest.data() + dest.size();
+		for (std::uint32_t curr_val : s) {
+			std::optional<codepoint> ocp = codepoint::to_codepoint(curr_val);
+			p = encode_utf8(*ocp, p, p_end);
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u8_encode_utf8_end_pointer_dataset_2);
+
+
+//
+// Unchecked construction
+//
+// Dataset 2 holds only valid codepoints, so the is_valid_cp() test and the optional in to_utf8 and
+// to_codepoint are redundant.  Compare against u32_to_u8_generator_get_all_dataset_2 and
+// u32_to_u8_encode_utf8_dataset_2.
+
+static void u32_to_u8_to_utf8_dataset_2(benchmark::State& state) {
+	std::vector<std::uint8_t> dest;
+	dest.reserve(get_random_codepoints_dataset_2_utf8().size());
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	for (auto _ : state) {
+		dest.clear();
+		std::back_insert_iterator oit(dest);
+		for (std::uint32_t curr_val : s) {
+			oit = to_utf8(curr_val, oit);
+		}
+		benchmark::DoNotOptimize(oit);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u8_to_utf8_dataset_2);
+
+static void u32_to_u8_to_utf8_unchecked_dataset_2(benchmark::State& state) {
+	std::vector<std::uint8_t> dest;
+	dest.reserve(get_random_codepoints_dataset_2_utf8().size());
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	for (auto _ : state) {
+		dest.clear();
+		std::back_insert_iterator oit(dest);
+		for (std::uint32_t curr_val : s) {
+			oit = to_utf8_unchecked(curr_val, oit);
+		}
+		benchmark::DoNotOptimize(oit);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u8_to_utf8_unchecked_dataset_2);
+
+static void u32_to_u8_encode_utf8_unchecked_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	std::vector<std::uint8_t> dest(get_random_codepoints_dataset_2_utf8().size() + 3);
+	for (auto _ : state) {
+		std::uint8_t* p = dest.data();
+		for (std::uint32_t curr_val : s) {
+			p = encode_utf8(codepoint::to_codepoint_unchecked(curr_val), p);
+		}
+		benchmark::DoNotOptimize(p);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u8_encode_utf8_unchecked_dataset_2);
+
+static void u32_to_u16_to_utf16_dataset_2(benchmark::State& state) {
+	std::vector<std::uint16_t> dest;
+	dest.reserve(get_random_codepoints_dataset_2_utf16().size());
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	for (auto _ : state) {
+		dest.clear();
+		std::back_insert_iterator oit(dest);
+		for (std::uint32_t curr_val : s) {
+			oit = to_utf16(curr_val, oit);
+		}
+		benchmark::DoNotOptimize(oit);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u16_to_utf16_dataset_2);
+
+static void u32_to_u16_to_utf16_unchecked_dataset_2(benchmark::State& state) {
+	std::vector<std::uint16_t> dest;
+	dest.reserve(get_random_codepoints_dataset_2_utf16().size());
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	for (auto _ : state) {
+		dest.clear();
+		std::back_insert_iterator oit(dest);
+		for (std::uint32_t curr_val : s) {
+			oit = to_utf16_unchecked(curr_val, oit);
+		}
+		benchmark::DoNotOptimize(oit);
+		benchmark::DoNotOptimize(dest);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_to_u16_to_utf16_unchecked_dataset_2);
@@ -2,9 +2,11 @@
 #include "benchmark_data.h"
 #include "utflib/utflib.h"
 #include "utflib/iterators.h"
+#include <vector>
+#include <cstdint>
 
 
-static void u8it_valid_eqproblen_fwd(benchmark::State& state) {
+static void u8_iter_fwd_dataset_1(benchmark::State& state) {
 	// 2025/02/01:  71607 ns        51618 ns
 	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
 	for (auto _ : state) {
@@ -14,10 +16,11 @@ static void u8it_valid_eqproblen_fwd(benchmark::State& state) {
 		}
 		benchmark::DoNotOptimize(it);
 	}
+	set_throughput(state, s);
 }
-BENCHMARK(u8it_valid_eqproblen_fwd);
+BENCHMARK(u8_iter_fwd_dataset_1);
 
-static void u8it_valid_eqproblen_rev(benchmark::State& state) {
+static void u8_iter_rev_dataset_1(benchmark::State& state) {
 	// 2025/02/01:  160902 ns       126596 ns
 	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
 	utf8_iterator it_end {s};
@@ -31,6 +34,46 @@ static void u8it_valid_eqproblen_rev(benchmark::State& state) {
 		}
 		benchmark::DoNotOptimize(it);
 	}
+	set_throughput(state, s);
 }
-BENCHMARK(u8it_valid_eqproblen_rev);
+BENCHMARK(u8_iter_rev_dataset_1);
 
+
+
+// Tokenizer-like use:  collect every character of dataset 1 into a vector, then decode the vector.  The
+// views are 16 bytes each and refer back to the source; the packed chars are 4 bytes each.
+static void u8_collect_views_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	std::vector<utf8_codepoint> chars;
+	for (auto _ : state) {
+		chars.clear();
+		for (utf8_iterator it {s}; !it.is_finished(); it.go_next()) {
+			chars.push_back(*it.get());
+		}
+		std::uint32_t sum {};
+		for (utf8_codepoint c : chars) {
+			sum += codepoint(c).get();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_collect_views_dataset_1);
+
+static void u8_collect_packed_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	std::vector<packed_utf8_char> chars;
+	for (auto _ : state) {
+		chars.clear();
+		for (utf8_iterator it {s}; !it.is_finished(); it.go_next()) {
+			chars.push_back(*it.get_packed());
+		}
+		std::uint32_t sum {};
+		for (packed_utf8_char c : chars) {
+			sum += codepoint(c).get();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_collect_packed_dataset_1);
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include "utflib/line_index.h"
+#include <vector>
+#include <span>
+#include <cstdint>
+
+
+//
+// Line indexing
+//
+// Dataset 2 has an 0x0A every 20 codepoints.  Compares index_utf8_lines, which finds the line starts,
+// counts codepoints and validates in one pass, with splitting on 0x0A and then running a utf8_iterator
+// over each line.
+
+static void u8_lines_two_pass_dataset_2(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_random_codepoints_dataset_2_utf8();
+	std::vector<std::size_t> offsets;
+	std::vector<std::size_t> n_cp;
+	std::vector<bool> is_valid;
+	for (auto _ : state) {
+		offsets.clear();
+		n_cp.clear();
+		is_valid.clear();
+		// Pass 1:  split
+		for (std::size_t i=0; i<s.size(); ++i) {
+			if (i==0 || s[i-1]==0x0Au) {
+				offsets.push_back(i);
+			}
+		}
+		// Pass 2:  iterate each line
+		for (std::size_t i=0; i<offsets.size(); ++i) {
+			std::size_t end = (i+1<offsets.size()) ? offsets[i+1] : s.size();
+			std::size_t n {0};
+			bool valid {true};
+			utf8_iterator it(s.subspan(offsets[i], end-offsets[i]));
+			while (!it.is_finished()) {
+				if (it.get_codepoint()) {
+					++n;
+				} else {
+					valid = false;
+				}
+				it.go_next();
+			}
+			n_cp.push_back(n);
+			is_valid.push_back(valid);
+		}
+		benchmark::DoNotOptimize(offsets);
+		benchmark::DoNotOptimize(n_cp);
+		benchmark::DoNotOptimize(is_valid);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_lines_two_pass_dataset_2);
+
+static void u8_lines_index_dataset_2(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_random_codepoints_dataset_2_utf8();
+	for (auto _ : state) {
+		std::vector<utf8_line> lines = index_utf8_lines(s);
+		benchmark::DoNotOptimize(lines);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_lines_index_dataset_2);
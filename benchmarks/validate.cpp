@@ -0,0 +1,239 @@
+#include <benchmark/benchmark.h>
+#include "benchmark_data.h"
+#include "utflib/low_level.h"
+#include "utflib/validate.h"
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+
+
+//
+// Whole-buffer validation
+//
+// The "scalar" benchmarks find the first invalid code unit one code unit at a time w/ the low-level
+// predicates, which is what the iterators do.
+
+// Dataset 1 has equal numbers of 1, 2, 3 and 4-byte sequences in random order, which is the worst
+// case for the if-else cascade in begins_with_valid_utf8.
+
+static void u8_validate_predicates_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	for (auto _ : state) {
+		std::size_t i {0};
+		while (i<s.size()) {
+			std::optional<int> sz = begins_with_valid_utf8(s.subspan(i));
+			if (!sz) {
+				break;
+			}
+			i += *sz;
+		}
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_validate_predicates_dataset_1);
+
+static void u8_validate_dfa_per_seq_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	for (auto _ : state) {
+		std::size_t i {0};
+		while (i<s.size()) {
+			std::optional<int> sz = begins_with_valid_utf8_dfa(s.subspan(i));
+			if (!sz) {
+				break;
+			}
+			i += *sz;
+		}
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_validate_dfa_per_seq_dataset_1);
+
+static void u8_validate_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	for (auto _ : state) {
+		std::size_t i = validate_utf8(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_validate_dataset_1);
+
+// As u8_validate, plus the error statistics & the histogram of sequence sizes
+static void u8_scan_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	for (auto _ : state) {
+		utf8_scan_report r = scan_utf8(s);
+		benchmark::DoNotOptimize(r);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_scan_dataset_1);
+
+static void u8_decode_predicates_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	for (auto _ : state) {
+		std::uint32_t sum {0};
+		std::size_t i {0};
+		while (i<s.size()) {
+			std::optional<int> sz = begins_with_valid_utf8(s.subspan(i));
+			if (!sz) {
+				break;
+			}
+			sum += to_utf32(s.subspan(i, *sz));
+			i += *sz;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_decode_predicates_dataset_1);
+
+static void u8_decode_dfa_dataset_1(benchmark::State& state) {
+	std::span<const std::uint8_t> s = get_utf8_equal_probability_code_unit_seq_length_dataset_1();
+	for (auto _ : state) {
+		std::uint32_t sum {0};
+		std::size_t i {0};
+		while (i<s.size()) {
+			std::optional<utf8_decoded> d = decode_utf8_dfa(s.subspan(i));
+			if (!d) {
+				break;
+			}
+			sum += d->cp;
+			i += d->sz;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u8_decode_dfa_dataset_1);
+
+// Emoji (U+1F600-U+1F64F, all surrogate pairs) w/ an 0x0A every 20 codepoints; the same shape as
+// dataset 2.
+static std::span<const std::uint16_t> get_emoji_utf16() {
+	static const std::vector<std::uint16_t> emoji = [](){
+		std::vector<std::uint16_t> r;
+		for (std::uint32_t i=0; i<10'000; ++i) {
+			if (i>0 && i%20 == 0) {
+				r.push_back(0x0Au);
+			}
+			const std::uint32_t cp = 0x1F600u + i%0x50u;
+			r.push_back(static_cast<std::uint16_t>(0xD800u + ((cp-0x10000u) >> 10)));
+			r.push_back(static_cast<std::uint16_t>(0xDC00u + ((cp-0x10000u) & 0x3FFu)));
+		}
+		return r;
+	}();
+	return emoji;
+}
+
+static std::size_t u16_validate_scalar(std::span<const std::uint16_t> s) {
+	std::size_t i {0};
+	while (i<s.size()) {
+		std::optional<int> sz = begins_with_valid_utf16(s.subspan(i));
+		if (!sz) {
+			break;
+		}
+		i += *sz;
+	}
+	return i;
+}
+
+static void u16_validate_scalar_dataset_2(benchmark::State& state) {
+	std::span<const std::uint16_t> s = get_random_codepoints_dataset_2_utf16();
+	for (auto _ : state) {
+		std::size_t i = u16_validate_scalar(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u16_validate_scalar_dataset_2);
+
+static void u16_validate_dataset_2(benchmark::State& state) {
+	std::span<const std::uint16_t> s = get_random_codepoints_dataset_2_utf16();
+	for (auto _ : state) {
+		std::size_t i = validate_utf16(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u16_validate_dataset_2);
+
+static void u16_validate_swapped_dataset_2(benchmark::State& state) {
+	std::span<const std::uint16_t> s = get_random_codepoints_dataset_2_utf16_swapped();
+	for (auto _ : state) {
+		std::size_t i = validate_utf16_swapped(s);
+		benchmark::DoNotOptimize(i);
+	}
+	// count_codepoints reads the words in host order
+	set_throughput(state, s.size_bytes(), count_codepoints(get_random_codepoints_dataset_2_utf16()));
+}
+BENCHMARK(u16_validate_swapped_dataset_2);
+
+static void u16_validate_scalar_emoji(benchmark::State& state) {
+	std::span<const std::uint16_t> s = get_emoji_utf16();
+	for (auto _ : state) {
+		std::size_t i = u16_validate_scalar(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u16_validate_scalar_emoji);
+
+static void u16_validate_emoji(benchmark::State& state) {
+	std::span<const std::uint16_t> s = get_emoji_utf16();
+	for (auto _ : state) {
+		std::size_t i = validate_utf16(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u16_validate_emoji);
+
+static void u32_validate_scalar_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	for (auto _ : state) {
+		std::size_t i {0};
+		while (i<s.size() && is_valid_utf32_codepoint(s[i])) {
+			++i;
+		}
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_validate_scalar_dataset_2);
+
+static void u32_validate_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32();
+	for (auto _ : state) {
+		std::size_t i = validate_utf32(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_validate_dataset_2);
+
+static void u32_validate_swapped_scalar_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32_swapped();
+	for (auto _ : state) {
+		std::size_t i {0};
+		while (i<s.size() && is_valid_utf32_codepoint_reversed(s[i])) {
+			++i;
+		}
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_validate_swapped_scalar_dataset_2);
+
+static void u32_validate_swapped_dataset_2(benchmark::State& state) {
+	std::span<const std::uint32_t> s = get_random_codepoints_dataset_2_utf32_swapped();
+	for (auto _ : state) {
+		std::size_t i = validate_utf32_swapped(s);
+		benchmark::DoNotOptimize(i);
+	}
+	set_throughput(state, s);
+}
+BENCHMARK(u32_validate_swapped_dataset_2);
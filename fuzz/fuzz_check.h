@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+// Each fuzz target runs the fast paths (SSE2, table-driven, branch-free) on the input and compares
+// their results w/ the scalar reference:  the predicates & begins_with_valid_utf8 in low_level.h, the
+// _alt iterators, and the generators in encoders.h.  Any difference aborts, which libFuzzer and AFL
+// report as a crash.
+
+inline void check(bool ok, const char* what) {
+	if (!ok) {
+		std::fprintf(stderr, "Fast path differs from the reference:  %s\n", what);
+		std::abort();
+	}
+}
+
+// The input as code units of type T in the byte order of the host; a partial code unit at the end is
+// dropped.  Copied, so that the code units are aligned.
+template<typename T>
+std::vector<T> to_code_units(const std::uint8_t* data, std::size_t size) {
+	std::vector<T> r(size/sizeof(T));
+	if (!r.empty()) {
+		std::memcpy(r.data(), data, r.size()*sizeof(T));
+	}
+	return r;
+}
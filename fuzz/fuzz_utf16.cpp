@@ -0,0 +1,80 @@
+#include "fuzz_check.h"
+#include "utflib/utflib.h"
+#include "utflib/low_level.h"
+#include "utflib/iterators.h"
+#include "utflib/validate.h"
+#include "utflib/byte_manip.h"
+#include "utflib/encoders.h"
+#include <algorithm>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+
+// The input as utf-16 in the byte order of the host.  Checks:
+//   validate_utf16, validate_utf16_swapped, byteswap_utf16,      against the predicates in low_level.h
+//   byteswap_and_validate_utf16                                  & reverse_bytes
+//   utf16_iterator_alt::get_packed, encode_utf16                 against utf16_iterator_alt::get
+
+static std::size_t validate_utf16_reference(std::span<const std::uint16_t> s) {
+	std::size_t i {0};
+	while (i < s.size()) {
+		if (is_valid_utf16_codepoint(s[i])) {
+			i += 1;
+		} else if (i+1 < s.size() && is_valid_utf16_surrogate_pair(s[i], s[i+1])) {
+			i += 2;
+		} else {
+			break;
+		}
+	}
+	return i;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+	const std::vector<std::uint16_t> v = to_code_units<std::uint16_t>(data, size);
+	const std::span<const std::uint16_t> s {v};
+
+	const std::size_t ref_valid_end = validate_utf16_reference(s);
+	check(validate_utf16(s) == ref_valid_end, "validate_utf16");
+
+	// Byte swapping
+	std::vector<std::uint16_t> ref_swapped(s.size());
+	std::transform(s.begin(), s.end(), ref_swapped.begin(), [](std::uint16_t w){ return reverse_bytes(w); });
+	std::vector<std::uint16_t> swapped(s.size());
+	byteswap_utf16(s, swapped);
+	check(swapped == ref_swapped, "byteswap_utf16");
+	byteswap_utf16(std::span<std::uint16_t>(swapped));
+	check(std::equal(swapped.begin(), swapped.end(), s.begin(), s.end()), "byteswap_utf16 in place");
+
+	// Reading the swapped data back recovers the input & validates it
+	check(validate_utf16_swapped(ref_swapped) == ref_valid_end, "validate_utf16_swapped");
+	std::vector<std::uint16_t> unswapped(s.size());
+	check(byteswap_and_validate_utf16(ref_swapped, unswapped) == ref_valid_end, "byteswap_and_validate_utf16");
+	check(std::equal(unswapped.begin(), unswapped.end(), s.begin(), s.end()), "byteswap_and_validate_utf16 output");
+
+	std::size_t it_first_error = s.size();
+	for (utf16_iterator_alt it {s}; !it.is_finished(); it.go_next()) {
+		const std::span<const std::uint16_t> u = it.get_underlying();
+		const std::optional<codepoint> cp = it.get_codepoint();
+		const std::optional<utf16_codepoint> w = it.get();
+		const std::optional<packed_utf16_char> p = it.get_packed();
+		check(w.has_value() == cp.has_value() && p.has_value() == cp.has_value(), "utf16_iterator_alt getters");
+		if (!cp) {
+			it_first_error = std::min(it_first_error, static_cast<std::size_t>(u.data() - s.data()));
+			continue;
+		}
+		check(*p == packed_utf16_char(*w), "utf16_iterator_alt::get_packed");
+		check(codepoint(*p) == *cp, "codepoint(packed_utf16_char)");
+
+		std::uint16_t buf[4] {};
+		std::uint16_t* end = encode_utf16(*cp, buf);
+		check(std::equal(buf, end, u.begin(), u.end()), "encode_utf16");
+		std::vector<std::uint16_t> exact(u.size());
+		check(encode_utf16(*cp, exact.data(), exact.data()+exact.size()) == exact.data()+exact.size()
+			&& std::equal(exact.begin(), exact.end(), u.begin()), "encode_utf16 w/ end");
+	}
+	check(it_first_error == ref_valid_end, "utf16_iterator_alt first error");
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include "fuzz_check.h"
+#include "utflib/utflib.h"
+#include "utflib/low_level.h"
+#include "utflib/validate.h"
+#include "utflib/byte_manip.h"
+#include "utflib/encoders.h"
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+
+// The input as utf-32 in the byte order of the host, ie arbitrary 32-bit values.  Checks:
+//   validate_utf32, validate_utf32_swapped, byteswap_utf32,  against codepoint::to_codepoint
+//   byteswap_and_validate_utf32                              & reverse_bytes
+//   encode_utf8, encode_utf16, to_utf8_unchecked,            against utf8_generator & utf16_generator
+//   to_utf16_unchecked
+
+static std::size_t validate_utf32_reference(std::span<const std::uint32_t> s) {
+	std::size_t i {0};
+	while (i < s.size() && codepoint::to_codepoint(s[i])) {
+		++i;
+	}
+	return i;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+	const std::vector<std::uint32_t> v = to_code_units<std::uint32_t>(data, size);
+	const std::span<const std::uint32_t> s {v};
+
+	const std::size_t ref_valid_end = validate_utf32_reference(s);
+	check(validate_utf32(s) == ref_valid_end, "validate_utf32");
+
+	std::vector<std::uint32_t> ref_swapped(s.size());
+	std::transform(s.begin(), s.end(), ref_swapped.begin(), [](std::uint32_t w){ return reverse_bytes(w); });
+	check(validate_utf32_swapped(ref_swapped) == ref_valid_end, "validate_utf32_swapped");
+	std::vector<std::uint32_t> swapped(s.size());
+	byteswap_utf32(s, swapped);
+	check(swapped == ref_swapped, "byteswap_utf32");
+	byteswap_utf32(std::span<std::uint32_t>(swapped));
+	check(std::equal(swapped.begin(), swapped.end(), s.begin(), s.end()), "byteswap_utf32 in place");
+	std::vector<std::uint32_t> unswapped(s.size());
+	check(byteswap_and_validate_utf32(ref_swapped, unswapped) == ref_valid_end, "byteswap_and_validate_utf32");
+	check(std::equal(unswapped.begin(), unswapped.end(), s.begin(), s.end()), "byteswap_and_validate_utf32 output");
+
+	// The encoders, on every value that is a codepoint
+	for (std::uint32_t w : s) {
+		const std::optional<codepoint> cp = codepoint::to_codepoint(w);
+		std::vector<std::uint8_t> checked8;
+		std::vector<std::uint16_t> checked16;
+		to_utf8(w, std::back_inserter(checked8));
+		to_utf16(w, std::back_inserter(checked16));
+		if (!cp) {
+			check(checked8.empty() && checked16.empty(), "to_utf8/to_utf16 of a non-codepoint");
+			continue;
+		}
+		std::vector<std::uint8_t> ref8;
+		std::vector<std::uint16_t> ref16;
+		for (utf8_generator g {*cp}; !g.is_finished(); g.go_next()) {
+			ref8.push_back(g.get());
+		}
+		for (utf16_generator g {*cp}; !g.is_finished(); g.go_next()) {
+			ref16.push_back(g.get());
+		}
+		check(checked8 == ref8, "to_utf8");
+		check(checked16 == ref16, "to_utf16");
+
+		std::uint8_t buf8[8] {};
+		std::uint8_t* end8 = encode_utf8(*cp, buf8);
+		check(std::equal(buf8, end8, ref8.begin(), ref8.end()), "encode_utf8");
+		std::vector<std::uint8_t> exact8(ref8.size());
+		check(encode_utf8(*cp, exact8.data(), exact8.data()+exact8.size()) == exact8.data()+exact8.size()
+			&& exact8 == ref8, "encode_utf8 w/ end");
+		check(encode_utf8(*cp, exact8.data(), exact8.data()+exact8.size()-1) == exact8.data(), "encode_utf8 w/o room");
+		std::vector<std::uint8_t> unchecked8;
+		to_utf8_unchecked(w, std::back_inserter(unchecked8));
+		check(unchecked8 == ref8, "to_utf8_unchecked");
+
+		std::uint16_t buf16[4] {};
+		std::uint16_t* end16 = encode_utf16(*cp, buf16);
+		check(std::equal(buf16, end16, ref16.begin(), ref16.end()), "encode_utf16");
+		std::vector<std::uint16_t> exact16(ref16.size());
+		check(encode_utf16(*cp, exact16.data(), exact16.data()+exact16.size()) == exact16.data()+exact16.size()
+			&& exact16 == ref16, "encode_utf16 w/ end");
+		check(encode_utf16(*cp, exact16.data(), exact16.data()+exact16.size()-1) == exact16.data(), "encode_utf16 w/o room");
+		std::vector<std::uint16_t> unchecked16;
+		to_utf16_unchecked(w, std::back_inserter(unchecked16));
+		check(unchecked16 == ref16, "to_utf16_unchecked");
+	}
+	return 0;
+}
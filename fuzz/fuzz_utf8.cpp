@@ -0,0 +1,140 @@
+#include "fuzz_check.h"
+#include "utflib/utflib.h"
+#include "utflib/low_level.h"
+#include "utflib/iterators.h"
+#include "utflib/validate.h"
+#include "utflib/line_index.h"
+#include "utflib/encoders.h"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+
+// The class of the ill-formed subsequence u, a maximal subpart, from its bytes and the byte after it
+// (if any), per the comments on utf8_error_class
+static utf8_error_class classify_utf8_error(std::span<const std::uint8_t> u, std::span<const std::uint8_t> rest) {
+	const std::uint8_t b0 = u[0];
+	if (b0 >= 0x80u && b0 <= 0xBFu) {
+		return utf8_error_class::lone_continuation;
+	}
+	if (b0 == 0xC0u || b0 == 0xC1u || b0 >= 0xF5u) {
+		return utf8_error_class::bad_leading;
+	}
+	if (u.size() == 1 && !rest.empty() && rest[0] >= 0x80u && rest[0] <= 0xBFu) {
+		if (b0 == 0xE0u || b0 == 0xF0u) {
+			return utf8_error_class::overlong;
+		}
+		if (b0 == 0xEDu) {
+			return utf8_error_class::surrogate;
+		}
+		if (b0 == 0xF4u) {
+			return utf8_error_class::too_large;
+		}
+	}
+	return utf8_error_class::truncated;
+}
+
+// The input as utf-8.  Checks:
+//   validate_utf8, begins_with_valid_utf8_dfa, decode_utf8_dfa  against begins_with_valid_utf8
+//   index_utf8_lines, scan_utf8                                 against utf8_iterator_alt
+//   scan_utf8 error classes                                     against classify_utf8_error
+//   utf8_iterator_alt::get_packed, encode_utf8                  against utf8_iterator_alt::get
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+	const std::span<const std::uint8_t> s {data, size};
+
+	// Validation stops at the first byte where begins_with_valid_utf8 fails
+	std::size_t ref_valid_end {0};
+	while (ref_valid_end < s.size()) {
+		std::optional<int> sz = begins_with_valid_utf8(s.subspan(ref_valid_end));
+		if (!sz) {
+			break;
+		}
+		ref_valid_end += *sz;
+	}
+	check(validate_utf8(s) == ref_valid_end, "validate_utf8");
+
+	// The DFA, starting at every byte
+	for (std::size_t i=0; i<s.size(); ++i) {
+		const std::span<const std::uint8_t> rest = s.subspan(i);
+		const std::optional<int> sz = begins_with_valid_utf8(rest);
+		check(begins_with_valid_utf8_dfa(rest) == sz, "begins_with_valid_utf8_dfa");
+		const std::optional<utf8_decoded> d = decode_utf8_dfa(rest);
+		check(d.has_value() == sz.has_value(), "decode_utf8_dfa validity");
+		if (d && sz) {
+			check(d->sz == *sz && d->cp == to_utf32(rest.subspan(0, *sz)), "decode_utf8_dfa codepoint");
+		}
+	}
+
+	// utf8_iterator_alt (maximal subparts) as the reference for lines, first error and re-encoding
+	std::vector<utf8_line> ref_lines;
+	utf8_line curr {0, 0, true};
+	std::size_t it_first_error = s.size();
+	std::size_t it_last_error = s.size();
+	std::size_t it_n_errors {0};
+	std::array<std::size_t,n_utf8_error_classes> it_n_errors_by_class {};
+	std::array<std::size_t,4> it_n_seq_by_size {};
+	for (utf8_iterator_alt it {s}; !it.is_finished(); it.go_next()) {
+		const std::span<const std::uint8_t> u = it.get_underlying();
+		const std::size_t offset = u.data() - s.data();
+		const std::optional<codepoint> cp = it.get_codepoint();
+		const std::optional<utf8_codepoint> v = it.get();
+		const std::optional<packed_utf8_char> p = it.get_packed();
+		check(v.has_value() == cp.has_value() && p.has_value() == cp.has_value(), "utf8_iterator_alt getters");
+
+		if (!cp) {
+			it_first_error = std::min(it_first_error, offset);
+			it_last_error = offset;
+			++it_n_errors;
+			++it_n_errors_by_class[static_cast<std::size_t>(classify_utf8_error(u, s.subspan(offset+u.size())))];
+			curr.is_valid = false;
+			continue;
+		}
+		check(*p == packed_utf8_char(*v), "utf8_iterator_alt::get_packed");
+		check(codepoint(*p) == *cp, "codepoint(packed_utf8_char)");
+
+		std::uint8_t buf[8] {};
+		std::uint8_t* end = encode_utf8(*cp, buf);
+		check(std::equal(buf, end, u.begin(), u.end()), "encode_utf8");
+		std::vector<std::uint8_t> exact(u.size());
+		check(encode_utf8(*cp, exact.data(), exact.data()+exact.size()) == exact.data()+exact.size()
+			&& std::equal(exact.begin(), exact.end(), u.begin()), "encode_utf8 w/ end");
+
+		++it_n_seq_by_size[u.size()-1];
+
+		if (cp->get() == 0x0Au) {
+			ref_lines.push_back(curr);
+			curr = utf8_line {offset+1, 0, true};
+		} else {
+			++curr.n_cp;
+		}
+	}
+	if (curr.offset < s.size()) {
+		ref_lines.push_back(curr);
+	}
+	check(it_first_error == ref_valid_end, "utf8_iterator_alt first error");
+
+	const utf8_scan_report r = scan_utf8(s);
+	check(r.n_errors == it_n_errors && r.first_error == it_first_error && r.last_error == it_last_error,
+		"scan_utf8 errors");
+	check(r.n_seq_by_size == it_n_seq_by_size, "scan_utf8 n_seq_by_size");
+	check(r.n_errors_by_class == it_n_errors_by_class, "scan_utf8 n_errors_by_class");
+	std::size_t n_classified {0};
+	for (std::size_t n : r.n_errors_by_class) {
+		n_classified += n;
+	}
+	check(n_classified == r.n_errors, "scan_utf8 n_errors_by_class sum");
+
+	const std::vector<utf8_line> lines = index_utf8_lines(s);
+	check(lines.size() == ref_lines.size(), "index_utf8_lines count");
+	for (std::size_t i=0; i<lines.size(); ++i) {
+		check(lines[i].offset == ref_lines[i].offset, "index_utf8_lines offset");
+		check(lines[i].n_cp == ref_lines[i].n_cp, "index_utf8_lines n_cp");
+		check(lines[i].is_valid == ref_lines[i].is_valid, "index_utf8_lines is_valid");
+	}
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+
+// For building the fuzz targets w/o libFuzzer:  runs LLVMFuzzerTestOneInput once on each file named on
+// the command line (the files in it, for a directory), or on stdin if there are none.  For replaying a
+// corpus or a crash, and for AFL, which runs the target w/ the input on stdin or in the file given by
+// @@.
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+static void run(std::istream& in) {
+	const std::vector<std::uint8_t> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	// A copy of exactly the size of the input, so that a sanitizer catches reads past the end
+	std::vector<std::uint8_t> exact(input.begin(), input.end());
+	LLVMFuzzerTestOneInput(exact.data(), exact.size());
+}
+
+static bool run_file(const std::filesystem::path& fp) {
+	std::ifstream f(fp, std::ios::binary);
+	if (!f) {
+		std::fprintf(stderr, "Could not open %s\n", fp.string().c_str());
+		return false;
+	}
+	run(f);
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		run(std::cin);
+		return 0;
+	}
+	std::size_t n_run {0};
+	for (int i=1; i<argc; ++i) {
+		const std::filesystem::path p {argv[i]};
+		if (std::filesystem::is_directory(p)) {
+			for (const auto& e : std::filesystem::recursive_directory_iterator(p)) {
+				if (e.is_regular_file() && run_file(e.path())) {
+					++n_run;
+				}
+			}
+		} else if (run_file(p)) {
+			++n_run;
+		}
+	}
+	std::fprintf(stderr, "Ran %zu inputs\n", n_run);
+	return 0;
+}
@@ -17,4 +17,50 @@ TEST(reverse_bytes, uint32) {
 	}
 }
 
+TEST(reverse_bytes, other_widths) {
+	EXPECT_EQ(reverse_bytes(std::uint8_t{0xABu}), 0xABu);
+	EXPECT_EQ(reverse_bytes(std::uint16_t{0xAABBu}), 0xBBAAu);
+	EXPECT_EQ(reverse_bytes(std::uint64_t{0x0102030405060708u}), 0x0807060504030201u);
+	EXPECT_EQ(reverse_bytes(std::int32_t{0x000000FF}), static_cast<std::int32_t>(0xFF000000u));
+	EXPECT_EQ(reverse_bytes(std::int16_t{-2}), static_cast<std::int16_t>(0xFEFFu));
+}
+
+TEST(reverse_bytes, constant_expression) {
+	static_assert(reverse_bytes(std::uint16_t{0xAABBu}) == 0xBBAAu);
+	static_assert(reverse_bytes(0xAA'BB'CC'DDu) == 0xDD'CC'BB'AAu);
+	static_assert(reverse_bytes(std::uint64_t{0x0102030405060708u}) == 0x0807060504030201u);
+}
 
+
+TEST(byteswap_utf16, in_place_and_out_of_place) {
+	// Lengths on either side of the vector width so that both the vector and scalar paths are exercised
+	for (std::size_t n=0; n<40; ++n) {
+		std::vector<std::uint16_t> src;
+		for (std::size_t i=0; i<n; ++i) {
+			src.push_back(static_cast<std::uint16_t>(0x0102u*(i+1)));
+		}
+		std::vector<std::uint16_t> dest(n);
+		byteswap_utf16(src, dest);
+		for (std::size_t i=0; i<n; ++i) {
+			EXPECT_EQ(dest[i], reverse_bytes(src[i]));
+		}
+		byteswap_utf16(dest);
+		EXPECT_EQ(dest, src);
+	}
+}
+
+TEST(byteswap_utf32, in_place_and_out_of_place) {
+	for (std::size_t n=0; n<40; ++n) {
+		std::vector<std::uint32_t> src;
+		for (std::size_t i=0; i<n; ++i) {
+			src.push_back(static_cast<std::uint32_t>(0x01020304u*(i+1)));
+		}
+		std::vector<std::uint32_t> dest(n);
+		byteswap_utf32(src, dest);
+		for (std::size_t i=0; i<n; ++i) {
+			EXPECT_EQ(dest[i], reverse_bytes(src[i]));
+		}
+		byteswap_utf32(dest);
+		EXPECT_EQ(dest, src);
+	}
+}
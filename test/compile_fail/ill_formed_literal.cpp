@@ -0,0 +1,5 @@
+#include "utflib/utflib.h"
+
+// Must not compile:  C0 80 is an overlong encoding of U+0000.  Checked at configure time by
+// test/CMakeLists.txt.
+constexpr utf8_literal x {u8"\xC0\x80"};
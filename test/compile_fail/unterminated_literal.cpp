@@ -0,0 +1,6 @@
+#include "utflib/utflib.h"
+
+// Must not compile:  w/o a terminating 0 the last character would be dropped.  Checked at
+// configure time by test/CMakeLists.txt.
+constexpr char hi[2] {'h', 'i'};
+constexpr utf8_literal x {hi};
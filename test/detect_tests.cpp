@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "utflib/detect.h"
+#include "utflib/encoders.h"
+#include "utflib/utflib.h"
+#include <span>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+
+
+// Ascii, Cyrillic, CJK and a codepoint outside the BMP, so that the utf-8 has sequences of every length
+// and the utf-16 a surrogate pair
+std::vector<std::uint32_t> detect_sample_text() {
+	std::vector<std::uint32_t> r {'T','h','e',' ','f','o','x',',',' ',
+		0x041Fu,0x0440u,0x0438u,0x0432u,0x0435u,0x0442u,' ',
+		0x6F22u,0x5B57u,0x30C6u,0x30ADu,0x30B9u,0x30C8u,' ',0x1F600u,'\n'};
+	return r;
+}
+
+std::vector<std::uint8_t> encode_as(std::span<const std::uint32_t> cps, utf_encoding enc) {
+	std::vector<std::uint8_t> r;
+	for (std::uint32_t u : cps) {
+		codepoint cp = *codepoint::to_codepoint(u);
+		if (enc == utf_encoding::utf8) {
+			utf8_generator(cp).get_all(std::back_inserter(r));
+		} else if (enc == utf_encoding::utf16le || enc == utf_encoding::utf16be) {
+			std::vector<std::uint16_t> w;
+			utf16_generator(cp).get_all(std::back_inserter(w));
+			for (std::uint16_t e : w) {
+				if (enc == utf_encoding::utf16le) {
+					r.insert(r.end(), {static_cast<std::uint8_t>(e), static_cast<std::uint8_t>(e>>8)});
+				} else {
+					r.insert(r.end(), {static_cast<std::uint8_t>(e>>8), static_cast<std::uint8_t>(e)});
+				}
+			}
+		} else if (enc == utf_encoding::utf32le) {
+			r.insert(r.end(), {static_cast<std::uint8_t>(u), static_cast<std::uint8_t>(u>>8),
+				static_cast<std::uint8_t>(u>>16), static_cast<std::uint8_t>(u>>24)});
+		} else {
+			r.insert(r.end(), {static_cast<std::uint8_t>(u>>24), static_cast<std::uint8_t>(u>>16),
+				static_cast<std::uint8_t>(u>>8), static_cast<std::uint8_t>(u)});
+		}
+	}
+	return r;
+}
+
+constexpr utf_encoding all_encodings[] {utf_encoding::utf8, utf_encoding::utf16le, utf_encoding::utf16be,
+	utf_encoding::utf32le, utf_encoding::utf32be};
+
+
+TEST(detect_encoding, bom) {
+	struct bom_testdata {
+		std::vector<std::uint8_t> bytes;
+		utf_encoding expect;
+		std::size_t bom_size;
+	};
+	std::vector<bom_testdata> td {
+		{{0xEFu,0xBBu,0xBFu,'a'}, utf_encoding::utf8, 3},
+		{{0xFFu,0xFEu,'a',0x00u}, utf_encoding::utf16le, 2},
+		{{0xFEu,0xFFu,0x00u,'a'}, utf_encoding::utf16be, 2},
+		{{0xFFu,0xFEu,0x00u,0x00u,'a',0x00u,0x00u,0x00u}, utf_encoding::utf32le, 4},
+		{{0x00u,0x00u,0xFEu,0xFFu,0x00u,0x00u,0x00u,'a'}, utf_encoding::utf32be, 4},
+		// A BOM wins even when what follows makes no sense in the encoding it implies
+		{{0xFEu,0xFFu,'a','b','c'}, utf_encoding::utf16be, 2},
+	};
+	for (const auto& e : td) {
+		detected_encoding r = detect_encoding(e.bytes);
+		EXPECT_EQ(r.best(), e.expect);
+		EXPECT_EQ(r.bom_size, e.bom_size);
+		EXPECT_EQ(r.ranked[0].score, 1.0);
+	}
+}
+
+TEST(detect_encoding, no_bom) {
+	const std::vector<std::uint32_t> text = detect_sample_text();
+	for (utf_encoding enc : all_encodings) {
+		std::vector<std::uint8_t> bytes = encode_as(text, enc);
+		detected_encoding r = detect_encoding(bytes);
+		EXPECT_EQ(r.best(), enc);
+		EXPECT_EQ(r.bom_size, 0);
+		// Utf-8 w/o 0x00 bytes tends to be valid utf-16 and wins only by the tie-break; everything else
+		// should win outright.
+		if (enc != utf_encoding::utf8) {
+			EXPECT_GT(r.ranked[0].score, r.ranked[1].score);
+		}
+	}
+}
+
+TEST(detect_encoding, prefix_cut_inside_a_sequence) {
+	// Long enough that the vector path is taken and the prefix ends inside a code unit sequence for
+	// each of the max_prefix values
+	std::vector<std::uint32_t> text;
+	for (int i=0; i<50; ++i) {
+		std::vector<std::uint32_t> t = detect_sample_text();
+		text.insert(text.end(), t.begin(), t.end());
+	}
+	for (utf_encoding enc : all_encodings) {
+		std::vector<std::uint8_t> bytes = encode_as(text, enc);
+		for (std::size_t max_prefix=100; max_prefix<140; ++max_prefix) {
+			detected_encoding r = detect_encoding(bytes, max_prefix);
+			EXPECT_EQ(r.best(), enc);
+		}
+	}
+}
+
+TEST(detect_encoding, truncated_input) {
+	// Cut off by the end of the input rather than the end of the prefix:  no longer well-formed
+	std::vector<std::uint8_t> bytes = encode_as(detect_sample_text(), utf_encoding::utf16le);
+	bytes.pop_back();
+	detected_encoding r = detect_encoding(bytes);
+	for (const encoding_guess& g : r.ranked) {
+		EXPECT_LT(g.score, 1.0);
+	}
+}
+
+TEST(detect_encoding, empty) {
+	detected_encoding r = detect_encoding({});
+	EXPECT_EQ(r.best(), utf_encoding::utf8);
+	EXPECT_EQ(r.bom_size, 0);
+}
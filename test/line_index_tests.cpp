@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "utf8_testdata.h"
+#include "utflib/line_index.h"
+#include "utflib/iterators.h"
+#include <span>
+#include <cstdint>
+#include <vector>
+#include <optional>
+
+
+// The two-pass approach index_utf8_lines replaces:  split on 0x0A, then run a utf8_iterator over each line.
+std::vector<utf8_line> index_utf8_lines_two_pass(std::span<const std::uint8_t> s) {
+	std::vector<utf8_line> lines;
+	std::size_t offset {0};
+	while (offset < s.size()) {
+		std::size_t end = offset;
+		while (end < s.size() && s[end] != 0x0Au) {
+			++end;
+		}
+		utf8_line ln {offset, 0, true};
+		utf8_iterator it(s.subspan(offset, end-offset));
+		while (!it.is_finished()) {
+			if (it.get_codepoint()) {
+				++ln.n_cp;
+			} else {
+				ln.is_valid = false;
+			}
+			it.go_next();
+		}
+		lines.push_back(ln);
+		offset = end+1;
+	}
+	return lines;
+}
+
+void expect_same_lines(const std::vector<utf8_line>& actual, const std::vector<utf8_line>& expect) {
+	ASSERT_EQ(actual.size(), expect.size());
+	for (std::size_t i=0; i<actual.size(); ++i) {
+		EXPECT_EQ(actual[i].offset, expect[i].offset);
+		EXPECT_EQ(actual[i].n_cp, expect[i].n_cp);
+		EXPECT_EQ(actual[i].is_valid, expect[i].is_valid);
+	}
+}
+
+TEST(index_utf8_lines, empty) {
+	EXPECT_TRUE(index_utf8_lines({}).empty());
+}
+
+TEST(index_utf8_lines, trailing_newline) {
+	std::vector<std::uint8_t> d {0x61, 0x0A, 0x0A, 0x62, 0x0A};
+	std::vector<utf8_line> lines = index_utf8_lines(d);
+	ASSERT_EQ(lines.size(), 3);
+	EXPECT_EQ(lines[0].offset, 0);
+	EXPECT_EQ(lines[0].n_cp, 1);
+	EXPECT_EQ(lines[1].offset, 2);
+	EXPECT_EQ(lines[1].n_cp, 0);
+	EXPECT_EQ(lines[2].offset, 3);
+	EXPECT_EQ(lines[2].n_cp, 1);
+}
+
+TEST(index_utf8_lines, valid) {
+	// All the valid sequences joined by newlines, with a long run of ascii in front of each one so that
+	// the block-at-a-time path sees newlines and multibyte sequences at every position in the block.
+	std::span<testdata_valid_utf8_utf32> td = get_valid_utf8_utf32_sequences();
+	for (int pad=0; pad<40; ++pad) {
+		std::vector<std::uint8_t> d;
+		for (const auto& e : td) {
+			d.insert(d.end(), pad, 0x61);
+			d.insert(d.end(), e.utf8.begin(), e.utf8.end());
+			d.push_back(0x0A);
+		}
+		std::vector<utf8_line> lines = index_utf8_lines(d);
+		expect_same_lines(lines, index_utf8_lines_two_pass(d));
+		for (const auto& ln : lines) {
+			EXPECT_TRUE(ln.is_valid);
+		}
+	}
+}
+
+TEST(index_utf8_lines, invalid) {
+	std::span<testdata_invalid_utf8_utf32> td = get_invalid_utf8_utf32_sequences();
+	for (int pad=0; pad<40; ++pad) {
+		std::vector<std::uint8_t> d;
+		for (const auto& e : td) {
+			d.insert(d.end(), pad, 0x61);
+			d.insert(d.end(), e.utf8.begin(), e.utf8.end());
+			d.push_back(0x0A);
+		}
+		std::vector<utf8_line> lines = index_utf8_lines(d);
+		expect_same_lines(lines, index_utf8_lines_two_pass(d));
+		// Some of the sequences contain a 0x0A of their own, but each one has errors on only one line
+		std::size_t n_invalid {0};
+		for (const auto& ln : lines) {
+			n_invalid += !ln.is_valid;
+		}
+		EXPECT_EQ(n_invalid, td.size());
+	}
+}
@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+#include "utf8_testdata.h"
+#include "utf16_testdata.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include "utflib/encoders.h"
+#include <span>
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+
+
+// Compares the packed value from get_packed() against the view from get() at every position, then
+// checks that the packed value decodes to the same codepoint as get_codepoint().
+template<typename It>
+void expect_packed_matches_view(It it) {
+	while (!it.is_finished()) {
+		auto v = it.get();
+		auto p = it.get_packed();
+		ASSERT_EQ(v.has_value(), p.has_value());
+		if (v) {
+			EXPECT_EQ(p->size(), v->size());
+			EXPECT_TRUE(std::equal(p->begin(), p->end(), v->begin(), v->end()));
+			EXPECT_EQ(codepoint(*p), *it.get_codepoint());
+		}
+		it.go_next();
+	}
+}
+
+
+//
+// utf-8
+//
+TEST(packed_utf8_char, all_codepoints) {
+	for (std::uint32_t v=0; v<=0x10FFFFu; ++v) {
+		if (!is_valid_cp(v)) {
+			continue;
+		}
+		std::vector<std::uint8_t> u8;
+		to_utf8(v, std::back_inserter(u8));
+		std::optional<packed_utf8_char> p = packed_utf8_char::to_packed_utf8_char(u8);
+		ASSERT_TRUE(p);
+		ASSERT_EQ(p->size(), u8.size());
+		ASSERT_TRUE(std::equal(p->begin(), p->end(), u8.begin(), u8.end()));
+		ASSERT_EQ(codepoint(*p).get(), v);
+	}
+}
+
+TEST(packed_utf8_char, invalid_and_default) {
+	std::vector<std::uint8_t> s {0xC0u, 0x80u};
+	EXPECT_FALSE(packed_utf8_char::to_packed_utf8_char(s));
+	s = {0x41u, 0x42u};  // Two codepoints
+	EXPECT_FALSE(packed_utf8_char::to_packed_utf8_char(s));
+
+	packed_utf8_char d {};
+	EXPECT_EQ(d.size(), 1);
+	EXPECT_EQ(codepoint(d).get(), 0);
+}
+
+TEST(packed_utf8_char, from_iterators) {
+	for (const auto& e : get_valid_utf8_utf32_sequences()) {
+		expect_packed_matches_view(utf8_iterator(e.utf8));
+		expect_packed_matches_view(utf8_iterator_alt(e.utf8));
+	}
+	for (const auto& e : get_invalid_utf8_utf32_sequences()) {
+		expect_packed_matches_view(utf8_iterator(e.utf8));
+		expect_packed_matches_view(utf8_iterator_alt(e.utf8));
+	}
+}
+
+TEST(packed_utf8_char, from_view) {
+	std::vector<std::uint8_t> s {0xF0u, 0x9Fu, 0x98u, 0x80u};
+	std::optional<utf8_codepoint> v = utf8_codepoint::to_utf8_codepoint(s);
+	ASSERT_TRUE(v);
+	packed_utf8_char p(*v);
+	EXPECT_EQ(p, *packed_utf8_char::to_packed_utf8_char(s));
+	EXPECT_EQ(codepoint(p).get(), 0x1F600u);
+}
+
+
+//
+// utf-16
+//
+TEST(packed_utf16_char, all_codepoints) {
+	for (std::uint32_t v=0; v<=0x10FFFFu; ++v) {
+		if (!is_valid_cp(v)) {
+			continue;
+		}
+		std::vector<std::uint16_t> u16;
+		to_utf16(v, std::back_inserter(u16));
+		std::optional<packed_utf16_char> p = packed_utf16_char::to_packed_utf16_char(u16);
+		ASSERT_TRUE(p);
+		ASSERT_EQ(p->size(), u16.size());
+		ASSERT_TRUE(std::equal(p->begin(), p->end(), u16.begin(), u16.end()));
+		ASSERT_EQ(codepoint(*p).get(), v);
+	}
+}
+
+TEST(packed_utf16_char, invalid_and_default) {
+	std::vector<std::uint16_t> s {0xD83Du};  // Unpaired leading surrogate
+	EXPECT_FALSE(packed_utf16_char::to_packed_utf16_char(s));
+	s = {0xDE00u, 0xD83Du};  // Reversed pair
+	EXPECT_FALSE(packed_utf16_char::to_packed_utf16_char(s));
+
+	packed_utf16_char d {};
+	EXPECT_EQ(d.size(), 1);
+	EXPECT_EQ(codepoint(d).get(), 0);
+}
+
+TEST(packed_utf16_char, from_iterators) {
+	for (const auto& e : get_valid_utf16_sequences()) {
+		expect_packed_matches_view(utf16_iterator(e.utf16));
+		expect_packed_matches_view(utf16_iterator_alt(e.utf16));
+	}
+	for (const auto& e : get_invalid_utf16_sequences()) {
+		expect_packed_matches_view(utf16_iterator(e.utf16));
+		expect_packed_matches_view(utf16_iterator_alt(e.utf16));
+	}
+}
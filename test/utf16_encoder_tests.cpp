@@ -4,6 +4,9 @@
 #include <span>
 #include <cstdint>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
 #include <optional>
 
 
@@ -18,3 +21,64 @@ TEST(encode_u32_to_u16, valid) {
 		EXPECT_EQ(v,curr_seq.u16);
 	}
 }
+
+TEST(encode_u32_to_u16, unchecked) {
+	std::span<encoder_testdata> td = get_encoder_testdata_valid();
+	for (const auto& curr_seq : td) {
+		std::vector<std::uint16_t> v;
+		auto it = std::back_inserter(v);
+		for (std::uint32_t cp : curr_seq.u32) {
+			it = to_utf16_unchecked(cp, it);
+		}
+		EXPECT_EQ(v,curr_seq.u16);
+	}
+}
+
+constexpr std::array<std::uint16_t,2> utf16_at_compile_time(std::uint32_t cp) {
+	std::array<std::uint16_t,2> r {};
+	to_utf16(cp, r.begin());
+	return r;
+}
+
+TEST(test_to_utf16, constant_expression) {
+	static_assert(utf16_at_compile_time(0x20ACu) == std::array<std::uint16_t,2> {0x20ACu, 0});
+	static_assert(utf16_at_compile_time(0x1F600u) == std::array<std::uint16_t,2> {0xD83Du, 0xDE00u});
+	static_assert(utf16_to_codepoint_value(0xD83Du, 0xDE00u) == 0x1F600u);
+}
+
+TEST(encode_utf16, all_codepoints) {
+	for (std::uint32_t v=0; v<=0x10FFFFu; ++v) {
+		std::optional<codepoint> cp = codepoint::to_codepoint(v);
+		if (!cp) {
+			continue;
+		}
+		std::vector<std::uint16_t> expect;
+		to_utf16(v, std::back_inserter(expect));
+		std::array<std::uint16_t,2> buf {};
+		std::uint16_t* p = encode_utf16(*cp, buf.data());
+		ASSERT_EQ(p-buf.data(), expect.size());
+		ASSERT_TRUE(std::equal(expect.begin(), expect.end(), buf.begin()));
+	}
+}
+
+TEST(encode_utf16, end_pointer) {
+	for (std::uint32_t v : {0x41u, 0x1F600u}) {
+		codepoint cp = *codepoint::to_codepoint(v);
+		std::vector<std::uint16_t> expect;
+		to_utf16(v, std::back_inserter(expect));
+		for (std::size_t room=0; room<=3; ++room) {
+			std::array<std::uint16_t,4> buf;
+			buf.fill(0xEEEEu);
+			std::uint16_t* p = encode_utf16(cp, buf.data(), buf.data()+room);
+			if (room < expect.size()) {
+				EXPECT_EQ(p, buf.data());
+			} else {
+				EXPECT_EQ(p-buf.data(), expect.size());
+				EXPECT_TRUE(std::equal(expect.begin(), expect.end(), buf.begin()));
+			}
+			for (std::size_t i=room; i<buf.size(); ++i) {
+				EXPECT_EQ(buf[i], 0xEEEEu);
+			}
+		}
+	}
+}
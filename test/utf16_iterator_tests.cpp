@@ -2,10 +2,12 @@
 #include "utf16_testdata.h"
 #include "utflib/iterators.h"
 #include "utflib/low_level.h"
+#include "utflib/byte_manip.h"
 #include <span>
 #include <cstdint>
 #include <vector>
 #include <optional>
+#include <ranges>
 
 //
 // utf-16 iterator
@@ -117,3 +119,69 @@ TEST(utf16_iterator_to_utf32_backward, invalid) {
 		EXPECT_TRUE(idx_u32 == 0);  // Verify the loop validated all codepoints
 	}
 }
+
+
+//
+// Byte-swapped tests
+//
+TEST(utf16_iterator_swapping_forward, valid_and_invalid) {
+	auto swapped_view = std::ranges::views::transform(reverse_bytes<std::uint16_t>);
+	for (auto td : {get_valid_utf16_sequences(), get_invalid_utf16_sequences()}) {
+		for (const auto& e : td) {
+			// Byte-swap the regular testdata
+			std::vector<std::uint16_t> e_swapped;
+			std::ranges::copy(e.utf16|swapped_view, std::back_insert_iterator(e_swapped));
+
+			utf16_iterator_swapping it(e_swapped);
+			std::size_t idx_u32 {0};
+			while (!it.is_finished()) {
+				ASSERT_TRUE(idx_u32 < e.utf32.size());
+				std::optional<codepoint> ocp = it.get_codepoint();
+				std::optional<utf16_codepoint_swapped> ou16 = it.get();
+				if (ocp) {
+					EXPECT_EQ(ocp->get(), e.utf32[idx_u32]);  // Note:  e, not e_swapped
+					ASSERT_TRUE(ou16.has_value());
+					// Verify that the iterator's utf16 and codepoint get()ters return the same thing
+					codepoint cp(*ou16);
+					EXPECT_EQ(cp, *ocp);
+				} else {
+					EXPECT_EQ(e.utf32[idx_u32], 0xFFFDu);
+					EXPECT_FALSE(ou16.has_value());
+				}
+				it.go_next();
+				++idx_u32;
+			}
+			EXPECT_TRUE(idx_u32 == e.utf32.size());
+		}
+	}
+}
+
+TEST(utf16_iterator_swapping_backward, valid_and_invalid) {
+	auto swapped_view = std::ranges::views::transform(reverse_bytes<std::uint16_t>);
+	for (auto td : {get_valid_utf16_sequences(), get_invalid_utf16_sequences()}) {
+		for (const auto& e : td) {
+			std::vector<std::uint16_t> e_swapped;
+			std::ranges::copy(e.utf16|swapped_view, std::back_insert_iterator(e_swapped));
+
+			utf16_iterator_swapping it(e_swapped);
+			while (!it.is_finished()) { it.go_next(); }
+			std::size_t idx_u32 {e.utf32.size()};
+			while (it.go_prev()) {
+				--idx_u32;
+				ASSERT_TRUE(idx_u32 < e.utf32.size());
+				std::optional<codepoint> ocp = it.get_codepoint();
+				std::optional<utf16_codepoint_swapped> ou16 = it.get();
+				if (ocp) {
+					EXPECT_EQ(ocp->get(), e.utf32[idx_u32]);
+					ASSERT_TRUE(ou16.has_value());
+					codepoint cp(*ou16);
+					EXPECT_EQ(cp, *ocp);
+				} else {
+					EXPECT_EQ(e.utf32[idx_u32], 0xFFFDu);
+					EXPECT_FALSE(ou16.has_value());
+				}
+			}
+			EXPECT_TRUE(idx_u32 == 0);  // Verify the loop visited every element
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "utf16_testdata.h"
 #include "utflib/low_level.h"
+#include "utflib/iterators.h"
 #include <span>
 #include <cstdint>
 #include <vector>
@@ -91,3 +92,34 @@ TEST(test_size_utf16_code_unit_seq_from_codepoint, valid_codepoints) {
 }
 
 
+
+TEST(test_truncate_utf16, valid) {
+	std::span<testdata_utf16_utf32_sequences> td = get_valid_utf16_sequences();
+	for (const auto& e : td) {
+		for (std::size_t max=0; max<=e.utf16.size()+1; ++max) {
+			// The reference:  the longest prefix no longer than max found by iterating from the start
+			utf16_iterator it(e.utf16);
+			std::size_t n {0};
+			while (!it.is_finished() && n + it.get_underlying().size() <= max) {
+				n += it.get_underlying().size();
+				it.go_next();
+			}
+			std::span<const std::uint16_t> r = truncate_utf16(e.utf16, max);
+			EXPECT_EQ(r.data(), e.utf16.data());
+			EXPECT_EQ(r.size(), n);
+			std::optional<std::span<const std::uint16_t>> rv = truncate_utf16_validate_tail(e.utf16, max);
+			ASSERT_TRUE(rv.has_value());
+			EXPECT_EQ(rv->size(), n);
+		}
+	}
+}
+
+TEST(test_truncate_utf16, invalid) {
+	// Unpaired leading surrogate followed by an unpaired trailing surrogate
+	std::vector<std::uint16_t> d {0x0061u, 0xD800u, 0x0062u, 0xDC00u, 0x0063u};
+	EXPECT_EQ(truncate_utf16(d, 2).size(), 2);
+	EXPECT_FALSE(truncate_utf16_validate_tail(d, 2).has_value());
+	EXPECT_EQ(truncate_utf16(d, 3).size(), 3);
+	EXPECT_TRUE(truncate_utf16_validate_tail(d, 3).has_value());
+	EXPECT_FALSE(truncate_utf16_validate_tail(d, 4).has_value());
+}
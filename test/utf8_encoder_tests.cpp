@@ -6,6 +6,9 @@
 #include <cstdint>
 #include <vector>
 #include <optional>
+#include <array>
+#include <algorithm>
+#include <iterator>
 
 
 TEST(test_to_utf8, valid) {
@@ -32,4 +35,76 @@ TEST(encode_u32_to_u8, valid) {
 	}
 }
 
+TEST(encode_u32_to_u8, unchecked) {
+	std::span<encoder_testdata> td = get_encoder_testdata_valid();
+	for (const auto& curr_seq : td) {
+		std::vector<std::uint8_t> v;
+		auto it = std::back_inserter(v);
+		for (std::uint32_t cp : curr_seq.u32) {
+			it = to_utf8_unchecked(cp, it);
+		}
+		EXPECT_EQ(v,curr_seq.u8);
+	}
+	static_assert(codepoint::to_codepoint_unchecked(0x1F600u) == *codepoint::to_codepoint(0x1F600u));
+}
+
 // TODO:  Tests for utf16 encoder (in a different file)
+
+// The generators and to_utf8 are usable in constant expressions, ex to build tables at compile time
+constexpr std::array<std::uint8_t,4> utf8_at_compile_time(std::uint32_t cp) {
+	std::array<std::uint8_t,4> r {};
+	to_utf8(cp, r.begin());
+	return r;
+}
+
+TEST(test_to_utf8, constant_expression) {
+	static_assert(utf8_at_compile_time(0x41u) == std::array<std::uint8_t,4> {0x41u, 0, 0, 0});
+	static_assert(utf8_at_compile_time(0xE9u) == std::array<std::uint8_t,4> {0xC3u, 0xA9u, 0, 0});
+	static_assert(utf8_at_compile_time(0x20ACu) == std::array<std::uint8_t,4> {0xE2u, 0x82u, 0xACu, 0});
+	static_assert(utf8_at_compile_time(0x1F600u) == std::array<std::uint8_t,4> {0xF0u, 0x9Fu, 0x98u, 0x80u});
+	// Invalid codepoints write nothing
+	static_assert(utf8_at_compile_time(0xD800u) == std::array<std::uint8_t,4> {0, 0, 0, 0});
+	static_assert(!codepoint::to_codepoint(0x110000u).has_value());
+	static_assert(codepoint::to_codepoint(0x10FFFFu)->get() == 0x10FFFFu);
+
+	constexpr utf8_generator g(*codepoint::to_codepoint(0x20ACu));
+	static_assert(!g.is_finished() && g.get() == 0xE2u);
+}
+
+TEST(encode_utf8, all_codepoints) {
+	for (std::uint32_t v=0; v<=0x10FFFFu; ++v) {
+		std::optional<codepoint> cp = codepoint::to_codepoint(v);
+		if (!cp) {
+			continue;
+		}
+		std::vector<std::uint8_t> expect;
+		to_utf8(v, std::back_inserter(expect));
+		std::array<std::uint8_t,4> buf {};
+		std::uint8_t* p = encode_utf8(*cp, buf.data());
+		ASSERT_EQ(p-buf.data(), expect.size());
+		ASSERT_TRUE(std::equal(expect.begin(), expect.end(), buf.begin()));
+	}
+}
+
+TEST(encode_utf8, end_pointer) {
+	// Nothing is written at or past dst_end, and nothing at all if the encoding doesn't fit
+	for (std::uint32_t v : {0x41u, 0xE9u, 0x20ACu, 0x1F600u}) {
+		codepoint cp = *codepoint::to_codepoint(v);
+		std::vector<std::uint8_t> expect;
+		to_utf8(v, std::back_inserter(expect));
+		for (std::size_t room=0; room<=6; ++room) {
+			std::array<std::uint8_t,8> buf;
+			buf.fill(0xEEu);
+			std::uint8_t* p = encode_utf8(cp, buf.data(), buf.data()+room);
+			if (room < expect.size()) {
+				EXPECT_EQ(p, buf.data());
+			} else {
+				EXPECT_EQ(p-buf.data(), expect.size());
+				EXPECT_TRUE(std::equal(expect.begin(), expect.end(), buf.begin()));
+			}
+			for (std::size_t i=room; i<buf.size(); ++i) {
+				EXPECT_EQ(buf[i], 0xEEu);
+			}
+		}
+	}
+}
@@ -1,10 +1,13 @@
 #include "gtest/gtest.h"
 #include "utf8_testdata.h"
 #include "utflib/low_level.h"
+#include "utflib/iterators.h"
+#include "utflib/utflib.h"
 #include <span>
 #include <cstdint>
 #include <vector>
 #include <optional>
+#include <array>
 
 
 TEST(test_is_valid_utf8_single_codepoint, valid) {
@@ -100,3 +103,100 @@ TEST(test_second_byte, invalid) {
 
 
 
+// The longest prefix no longer than max_bytes that ends on a codepoint boundary, found by iterating
+// from the start.  Only meaningful for valid sequences.
+std::size_t truncate_utf8_reference(std::span<const std::uint8_t> s, std::size_t max_bytes) {
+	utf8_iterator it(s);
+	std::size_t n {0};
+	while (!it.is_finished()) {
+		std::size_t sz = it.get_underlying().size();
+		if (n + sz > max_bytes) {
+			break;
+		}
+		n += sz;
+		it.go_next();
+	}
+	return n;
+}
+
+TEST(test_truncate_utf8, valid) {
+	std::span<testdata_valid_utf8_utf32> td = get_valid_utf8_utf32_sequences();
+	for (const auto& e : td) {
+		for (std::size_t max=0; max<=e.utf8.size()+1; ++max) {
+			std::span<const std::uint8_t> r = truncate_utf8(e.utf8, max);
+			EXPECT_EQ(r.data(), e.utf8.data());
+			EXPECT_EQ(r.size(), truncate_utf8_reference(e.utf8, max));
+			std::optional<std::span<const std::uint8_t>> rv = truncate_utf8_validate_tail(e.utf8, max);
+			ASSERT_TRUE(rv.has_value());
+			EXPECT_EQ(rv->size(), r.size());
+		}
+	}
+}
+
+TEST(test_truncate_utf8, invalid) {
+	// 0x80 is a stray trailing byte; the 2-byte sequence before it is complete and must be kept
+	std::vector<std::uint8_t> d {0x61, 0xC3, 0xA9, 0x80, 0x62};
+	EXPECT_EQ(truncate_utf8(d, 3).size(), 3);
+	EXPECT_FALSE(truncate_utf8_validate_tail(d, 4).has_value());
+	// The E2 sequence is truncated by the 0x41; cutting in the middle of it splits nothing valid
+	std::vector<std::uint8_t> t {0xE2, 0x82, 0x41, 0x42};
+	EXPECT_EQ(truncate_utf8(t, 2).size(), 2);
+	EXPECT_FALSE(truncate_utf8_validate_tail(t, 2).has_value());
+	EXPECT_EQ(truncate_utf8(t, 1).size(), 0);
+	// More than three trailing bytes:  ill-formed, cut at max_bytes
+	std::vector<std::uint8_t> c {0x61, 0x80, 0x80, 0x80, 0x80, 0x80};
+	EXPECT_EQ(truncate_utf8(c, 5).size(), 5);
+	EXPECT_FALSE(truncate_utf8_validate_tail(c, 5).has_value());
+}
+
+TEST(test_begins_with_valid_utf8_dfa, same_as_predicates) {
+	// Every first and second byte, and a selection of third and fourth bytes covering the boundaries of
+	// the ranges in Table 3-7, at every length from 0 to 4
+	const std::vector<std::uint8_t> tail_bytes {0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC2, 0xF4, 0xFF};
+	for (int b0=0; b0<256; ++b0) {
+		for (int b1=0; b1<256; ++b1) {
+			for (std::uint8_t b2 : tail_bytes) {
+				for (std::uint8_t b3 : tail_bytes) {
+					const std::array<std::uint8_t,4> s {static_cast<std::uint8_t>(b0), static_cast<std::uint8_t>(b1), b2, b3};
+					for (std::size_t n=0; n<=4; ++n) {
+						std::span<const std::uint8_t> sub(s.data(), n);
+						std::optional<int> expect = begins_with_valid_utf8(sub);
+						ASSERT_EQ(begins_with_valid_utf8_dfa(sub), expect);
+						std::optional<utf8_decoded> d = decode_utf8_dfa(sub);
+						ASSERT_EQ(d.has_value(), expect.has_value());
+						if (d) {
+							ASSERT_EQ(d->sz, *expect);
+							ASSERT_EQ(d->cp, to_utf32(sub));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(test_utf8_low_level, constant_expression) {
+	static_assert(is_valid_utf8_leading_byte(0xC2u) && !is_valid_utf8_leading_byte(0xC1u));
+	static_assert(is_valid_utf8_second_byte(0xA0u, 0xE0u) && !is_valid_utf8_second_byte(0x9Fu, 0xE0u));
+	static_assert(size_utf8_multibyte_seq_from_leading_byte(0xF0u) == 4);
+	static_assert(is_valid_cp(0x10FFFFu) && !is_valid_cp(0xDFFFu));
+	constexpr std::array<std::uint8_t,3> euro {0xE2u, 0x82u, 0xACu};
+	static_assert(begins_with_valid_utf8(euro) == 3);
+	static_assert(to_utf32(euro) == 0x20ACu);
+	static_assert(is_valid_utf8_single_codepoint(euro));
+	constexpr std::array<std::uint8_t,2> overlong {0xC0u, 0x80u};
+	static_assert(!begins_with_valid_utf8(overlong).has_value());
+}
+
+TEST(utf8_literal, valid) {
+	constexpr utf8_literal a {u8"Grüß Gott \U0001F600"};
+	static_assert(a.size() == 16);
+	constexpr utf8_literal b {"caf\xC3\xA9"};
+	static_assert(b.view() == "caf\xC3\xA9");
+	EXPECT_EQ(b.bytes().size(), 5);
+	EXPECT_EQ(b.bytes()[4], 0xA9u);
+	constexpr utf8_literal empty {""};
+	static_assert(empty.size() == 0);
+	// An ill-formed literal, ex utf8_literal {"\xC0\x80"}, and an array w/o a terminating 0 do not
+	// compile; see compile_fail/, which test/CMakeLists.txt checks at configure time.
+}
@@ -0,0 +1,325 @@
+#include "gtest/gtest.h"
+#include "utf16_testdata.h"
+#include "utf32_testdata.h"
+#include "utf8_testdata.h"
+#include "utflib/validate.h"
+#include "utflib/byte_manip.h"
+#include "utflib/iterators.h"
+#include <span>
+#include <cstdint>
+#include <vector>
+#include <optional>
+
+
+// Index of the first code unit not part of a well-formed sequence, by way of the _alt iterators, which
+// treat every such code unit as an individual error.
+std::size_t first_invalid_utf16_reference(std::span<const std::uint16_t> s) {
+	for (utf16_iterator_alt it(s); !it.is_finished(); it.go_next()) {
+		if (!it.get_codepoint()) {
+			return static_cast<std::size_t>(it.get_underlying().data()-s.data());
+		}
+	}
+	return s.size();
+}
+
+std::size_t first_invalid_utf32_reference(std::span<const std::uint32_t> s) {
+	utf32_iterator_alt it(s);
+	std::size_t i {0};
+	while (!it.is_finished() && it.get_codepoint()) {
+		it.go_next();
+		++i;
+	}
+	return i;
+}
+
+// Pads the test sequences with valid code units in front so that they land at every position
+// relative to the vector width, including straddling the edge of a vector.
+template<typename T>
+std::vector<std::vector<T>> with_padding(std::span<const T> s, T pad) {
+	std::vector<std::vector<T>> r;
+	for (std::size_t n=0; n<20; ++n) {
+		std::vector<T> v(n, pad);
+		v.insert(v.end(), s.begin(), s.end());
+		r.push_back(v);
+	}
+	return r;
+}
+
+TEST(byteswap_and_validate_utf16, valid_and_invalid) {
+	for (auto td : {get_valid_utf16_sequences(), get_invalid_utf16_sequences()}) {
+		for (const auto& e : td) {
+			for (const std::vector<std::uint16_t>& v : with_padding<std::uint16_t>(e.utf16, 0x0041u)) {
+				std::vector<std::uint16_t> swapped(v.size());
+				byteswap_utf16(v, swapped);
+				std::vector<std::uint16_t> dest(v.size());
+				EXPECT_EQ(byteswap_and_validate_utf16(swapped, dest), first_invalid_utf16_reference(v));
+				EXPECT_EQ(dest, v);
+			}
+		}
+	}
+}
+
+// The valid and invalid utf-32 test sequences in one list
+std::vector<std::vector<std::uint32_t>> get_utf32_validate_testdata() {
+	std::span<std::vector<std::uint32_t>> td_valid = get_valid_utf32_sequences();
+	std::span<testdata_invalid_utf32> td_invalid = get_invalid_utf32_sequences();
+	std::vector<std::vector<std::uint32_t>> td(td_valid.begin(), td_valid.end());
+	for (const auto& e : td_invalid) {
+		td.push_back(e.utf32_invalid);
+	}
+	return td;
+}
+
+TEST(byteswap_and_validate_utf32, valid_and_invalid) {
+	for (const auto& e : get_utf32_validate_testdata()) {
+		for (const std::vector<std::uint32_t>& v : with_padding<std::uint32_t>(e, 0x41u)) {
+			std::vector<std::uint32_t> swapped(v.size());
+			byteswap_utf32(v, swapped);
+			std::vector<std::uint32_t> dest(v.size());
+			EXPECT_EQ(byteswap_and_validate_utf32(swapped, dest), first_invalid_utf32_reference(v));
+			EXPECT_EQ(dest, v);
+		}
+	}
+}
+
+TEST(validate_utf32, valid_and_invalid) {
+	for (const auto& e : get_utf32_validate_testdata()) {
+		for (const std::vector<std::uint32_t>& v : with_padding<std::uint32_t>(e, 0x41u)) {
+			EXPECT_EQ(validate_utf32(v), first_invalid_utf32_reference(v));
+		}
+	}
+}
+
+TEST(validate_utf32_swapped, valid_and_invalid) {
+	for (const auto& e : get_utf32_validate_testdata()) {
+		for (const std::vector<std::uint32_t>& v : with_padding<std::uint32_t>(e, 0x41u)) {
+			std::vector<std::uint32_t> swapped(v.size());
+			byteswap_utf32(v, swapped);
+			EXPECT_EQ(validate_utf32_swapped(swapped), first_invalid_utf32_reference(v));
+		}
+	}
+}
+
+TEST(validate_utf32, range_edges) {
+	// Each value at every position of a block of 8 and of the tail
+	std::vector<std::pair<std::uint32_t,bool>> td {{
+		{0x0u, true}, {0xD7FFu, true}, {0xD800u, false}, {0xDBFFu, false}, {0xDC00u, false},
+		{0xDFFFu, false}, {0xE000u, true}, {0x10FFFFu, true}, {0x110000u, false}, {0x7FFFFFFFu, false},
+		{0x80000000u, false}, {0xFFFFFFFFu, false}
+	}};
+	for (const auto& e : td) {
+		for (std::size_t n=1; n<20; ++n) {
+			for (std::size_t i=0; i<n; ++i) {
+				std::vector<std::uint32_t> v(n, 0x41u);
+				v[i] = e.first;
+				EXPECT_EQ(validate_utf32(v), e.second ? n : i);
+				byteswap_utf32(v);
+				EXPECT_EQ(validate_utf32_swapped(v), e.second ? n : i);
+			}
+		}
+	}
+}
+
+TEST(validate_utf16, valid_and_invalid) {
+	for (auto td : {get_valid_utf16_sequences(), get_invalid_utf16_sequences()}) {
+		for (const auto& e : td) {
+			for (const std::vector<std::uint16_t>& v : with_padding<std::uint16_t>(e.utf16, 0x0041u)) {
+				EXPECT_EQ(validate_utf16(v), first_invalid_utf16_reference(v));
+			}
+		}
+	}
+}
+
+TEST(validate_utf16_swapped, valid_and_invalid) {
+	for (auto td : {get_valid_utf16_sequences(), get_invalid_utf16_sequences()}) {
+		for (const auto& e : td) {
+			for (const std::vector<std::uint16_t>& v : with_padding<std::uint16_t>(e.utf16, 0x0041u)) {
+				std::vector<std::uint16_t> swapped(v.size());
+				byteswap_utf16(v, swapped);
+				const std::vector<std::uint16_t> swapped_before = swapped;
+				EXPECT_EQ(validate_utf16_swapped(swapped), first_invalid_utf16_reference(v));
+				EXPECT_EQ(swapped, swapped_before);
+			}
+		}
+	}
+}
+
+TEST(validate_utf16, surrogates_at_block_edges) {
+	// Lone and paired surrogates at every position of the first few blocks, including pairs split
+	// across the edge of a block and lone leading surrogates at the very end
+	for (std::size_t n=1; n<50; ++n) {
+		for (std::size_t i=0; i<n; ++i) {
+			for (std::uint16_t w : {std::uint16_t{0xD800u}, std::uint16_t{0xDBFFu}, std::uint16_t{0xDC00u}, std::uint16_t{0xDFFFu}}) {
+				std::vector<std::uint16_t> v(n, 0x0041u);
+				v[i] = w;
+				const std::size_t expect = first_invalid_utf16_reference(v);
+				EXPECT_EQ(validate_utf16(v), expect);
+				byteswap_utf16(std::span<std::uint16_t>(v));
+				EXPECT_EQ(validate_utf16_swapped(v), expect);
+			}
+			if (i+1 < n) {
+				std::vector<std::uint16_t> v(n, 0x0041u);
+				v[i] = 0xD83Du;
+				v[i+1] = 0xDE00u;
+				EXPECT_EQ(validate_utf16(v), n);
+				std::vector<std::uint16_t> swapped(n);
+				byteswap_utf16(v, swapped);
+				EXPECT_EQ(validate_utf16_swapped(swapped), n);
+				// Two leading surrogates in a row
+				v[i+1] = 0xD83Du;
+				EXPECT_EQ(validate_utf16(v), i);
+				byteswap_utf16(v, swapped);
+				EXPECT_EQ(validate_utf16_swapped(swapped), i);
+			}
+		}
+	}
+}
+
+std::size_t first_invalid_utf8_reference(std::span<const std::uint8_t> s) {
+	for (utf8_iterator_alt it(s); !it.is_finished(); it.go_next()) {
+		if (!it.get_codepoint()) {
+			return static_cast<std::size_t>(it.get_underlying().data()-s.data());
+		}
+	}
+	return s.size();
+}
+
+TEST(validate_utf8, valid_and_invalid) {
+	std::vector<std::vector<std::uint8_t>> td;
+	for (const auto& e : get_valid_utf8_utf32_sequences()) {
+		td.push_back(e.utf8);
+	}
+	for (const auto& e : get_invalid_utf8_utf32_sequences()) {
+		td.push_back(e.utf8);
+	}
+	for (const auto& e : td) {
+		// Ascii padding in front moves the sequences across the edges of the ascii blocks; a copy of the
+		// sequence in front makes the machine run through the edge of a block
+		for (const std::vector<std::uint8_t>& v : with_padding<std::uint8_t>(e, 0x41u)) {
+			EXPECT_EQ(validate_utf8(v), first_invalid_utf8_reference(v));
+			std::vector<std::uint8_t> twice = v;
+			twice.insert(twice.end(), e.begin(), e.end());
+			EXPECT_EQ(validate_utf8(twice), first_invalid_utf8_reference(twice));
+		}
+	}
+}
+
+// The report scan_utf8 should give, by way of utf8_iterator_alt, whose errors are the maximal subparts
+utf8_scan_report scan_utf8_reference(std::span<const std::uint8_t> s) {
+	utf8_scan_report r {};
+	r.first_error = s.size();
+	r.last_error = s.size();
+	for (utf8_iterator_alt it(s); !it.is_finished(); it.go_next()) {
+		std::span<const std::uint8_t> u = it.get_underlying();
+		if (it.get_codepoint()) {
+			++r.n_seq_by_size[u.size()-1];
+		} else {
+			r.first_error = (r.n_errors == 0) ? static_cast<std::size_t>(u.data()-s.data()) : r.first_error;
+			r.last_error = static_cast<std::size_t>(u.data()-s.data());
+			++r.n_errors;
+		}
+	}
+	return r;
+}
+
+void expect_scan_utf8_matches_reference(std::span<const std::uint8_t> s) {
+	const utf8_scan_report r = scan_utf8(s);
+	const utf8_scan_report ref = scan_utf8_reference(s);
+	EXPECT_EQ(r.n_errors, ref.n_errors);
+	EXPECT_EQ(r.first_error, ref.first_error);
+	EXPECT_EQ(r.last_error, ref.last_error);
+	EXPECT_EQ(r.n_seq_by_size, ref.n_seq_by_size);
+	std::size_t n_by_class {0};
+	for (std::size_t n : r.n_errors_by_class) {
+		n_by_class += n;
+	}
+	EXPECT_EQ(n_by_class, r.n_errors);
+	EXPECT_EQ(r.is_valid(), validate_utf8(s) == s.size());
+	EXPECT_EQ(r.first_error, r.is_valid() ? s.size() : validate_utf8(s));
+}
+
+TEST(scan_utf8, valid_and_invalid) {
+	std::vector<std::vector<std::uint8_t>> td;
+	for (const auto& e : get_valid_utf8_utf32_sequences()) {
+		td.push_back(e.utf8);
+	}
+	for (const auto& e : get_invalid_utf8_utf32_sequences()) {
+		td.push_back(e.utf8);
+	}
+	for (const auto& e : td) {
+		for (const std::vector<std::uint8_t>& v : with_padding<std::uint8_t>(e, 0x41u)) {
+			expect_scan_utf8_matches_reference(v);
+			std::vector<std::uint8_t> twice = v;
+			twice.insert(twice.end(), e.begin(), e.end());
+			expect_scan_utf8_matches_reference(twice);
+		}
+	}
+}
+
+TEST(scan_utf8, error_classes) {
+	struct testdata {
+		std::vector<std::uint8_t> utf8;
+		utf8_error_class c;  // Of the first error
+		std::size_t n_lone_continuation;  // The bytes after it
+	};
+	const std::vector<testdata> td {
+		{{0x80u}, utf8_error_class::lone_continuation, 0},
+		{{0xBFu, 0x41u}, utf8_error_class::lone_continuation, 0},
+		{{0xC0u, 0x80u}, utf8_error_class::bad_leading, 1},
+		{{0xC1u, 0xBFu}, utf8_error_class::bad_leading, 1},
+		{{0xF5u, 0x80u, 0x80u, 0x80u}, utf8_error_class::bad_leading, 3},
+		{{0xFFu}, utf8_error_class::bad_leading, 0},
+		{{0xE0u, 0x80u, 0x80u}, utf8_error_class::overlong, 2},
+		{{0xE0u, 0x9Fu, 0xBFu}, utf8_error_class::overlong, 2},
+		{{0xF0u, 0x8Fu, 0xBFu, 0xBFu}, utf8_error_class::overlong, 3},
+		{{0xEDu, 0xA0u, 0x80u}, utf8_error_class::surrogate, 2},
+		{{0xEDu, 0xBFu, 0xBFu}, utf8_error_class::surrogate, 2},
+		{{0xF4u, 0x90u, 0x80u, 0x80u}, utf8_error_class::too_large, 3},
+		{{0xC2u}, utf8_error_class::truncated, 0},
+		{{0xC2u, 0x41u}, utf8_error_class::truncated, 0},
+		{{0xE1u, 0x80u, 0x41u}, utf8_error_class::truncated, 0},
+		{{0xF0u, 0x90u, 0x80u}, utf8_error_class::truncated, 0},
+		{{0xF4u, 0x8Fu, 0xBFu, 0xC2u, 0xA9u}, utf8_error_class::truncated, 0},
+	};
+	for (const auto& e : td) {
+		for (const std::vector<std::uint8_t>& v : with_padding<std::uint8_t>(e.utf8, 0x41u)) {
+			const utf8_scan_report r = scan_utf8(v);
+			const std::size_t n_pad = v.size() - e.utf8.size();
+			EXPECT_EQ(r.first_error, n_pad);
+			EXPECT_EQ(r.n_errors, 1 + e.n_lone_continuation);
+			if (e.c == utf8_error_class::lone_continuation) {
+				EXPECT_EQ(r.n_errors_of(e.c), 1 + e.n_lone_continuation);
+			} else {
+				EXPECT_EQ(r.n_errors_of(e.c), 1);
+				EXPECT_EQ(r.n_errors_of(utf8_error_class::lone_continuation), e.n_lone_continuation);
+			}
+		}
+	}
+}
+
+TEST(scan_utf8, long_text_w_errors) {
+	// "a", U+00E9, U+4E2D, U+1F600:  one sequence of each size in 10 bytes
+	const std::vector<std::uint8_t> unit {0x61u, 0xC3u, 0xA9u, 0xE4u, 0xB8u, 0xADu, 0xF0u, 0x9Fu, 0x98u, 0x80u};
+	std::vector<std::uint8_t> s;
+	for (int i=0; i<100; ++i) {
+		s.insert(s.end(), unit.begin(), unit.end());
+	}
+	utf8_scan_report r = scan_utf8(s);
+	EXPECT_TRUE(r.is_valid());
+	EXPECT_EQ(r.first_error, s.size());
+	EXPECT_EQ(r.last_error, s.size());
+	EXPECT_EQ(r.n_seq_by_size, (std::array<std::size_t,4> {100, 100, 100, 100}));
+
+	// Replace the leading bytes of a U+00E9 and a U+1F600 w/ 0xFF; their trailing bytes become lone
+	// continuation bytes
+	s[571] = 0xFFu;
+	s[906] = 0xFFu;
+	r = scan_utf8(s);
+	EXPECT_FALSE(r.is_valid());
+	EXPECT_EQ(r.first_error, 571);
+	EXPECT_EQ(r.last_error, 909);
+	EXPECT_EQ(r.n_errors_of(utf8_error_class::bad_leading), 2);
+	EXPECT_EQ(r.n_errors_of(utf8_error_class::lone_continuation), 4);
+	EXPECT_EQ(r.n_seq_by_size, (std::array<std::size_t,4> {100, 99, 100, 99}));
+	expect_scan_utf8_matches_reference(s);
+}
@@ -0,0 +1,199 @@
+#include "check.h"
+
+#include "utflib/low_level.h"
+#include "utflib/validate.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <optional>
+#include <string_view>
+#include <bit>
+#include <vector>
+#include <algorithm>
+
+
+std::optional<encoding_form> to_encoding_form(std::string_view name) {
+	if (name == "utf8") { return encoding_form::utf8; }
+	if (name == "utf16le") { return encoding_form::utf16le; }
+	if (name == "utf16be") { return encoding_form::utf16be; }
+	if (name == "utf32le") { return encoding_form::utf32le; }
+	if (name == "utf32be") { return encoding_form::utf32be; }
+	if (name == "utf16") {
+		return std::endian::native == std::endian::little ? encoding_form::utf16le : encoding_form::utf16be;
+	}
+	if (name == "utf32") {
+		return std::endian::native == std::endian::little ? encoding_form::utf32le : encoding_form::utf32be;
+	}
+	return std::nullopt;
+}
+
+std::string_view to_string(encoding_form e) {
+	switch (e) {
+		case encoding_form::utf8: return "utf8";
+		case encoding_form::utf16le: return "utf16le";
+		case encoding_form::utf16be: return "utf16be";
+		case encoding_form::utf32le: return "utf32le";
+		case encoding_form::utf32be: return "utf32be";
+	}
+	return "";
+}
+
+std::size_t code_unit_size(encoding_form e) {
+	switch (e) {
+		case encoding_form::utf8: return 1;
+		case encoding_form::utf16le: case encoding_form::utf16be: return 2;
+		case encoding_form::utf32le: case encoding_form::utf32be: return 4;
+	}
+	return 1;
+}
+
+static std::optional<int> begins_with_valid_utf32_swapped(std::span<const std::uint32_t> s) {
+	if (!s.empty() && is_valid_utf32_codepoint_reversed(s[0])) {
+		return 1;
+	}
+	return std::nullopt;
+}
+
+// The number of codepoints in s, which is known to be well-formed:  the code units that don't
+// continue a sequence
+static std::size_t count_cp_utf8(std::span<const std::uint8_t> s) {
+	return static_cast<std::size_t>(std::ranges::count_if(s, [](std::uint8_t b) { return (b & 0xC0u) != 0x80u; }));
+}
+static std::size_t count_cp_utf16(std::span<const std::uint16_t> s) {
+	return static_cast<std::size_t>(std::ranges::count_if(s, [](std::uint16_t w) { return (w & 0xFC00u) != 0xDC00u; }));
+}
+static std::size_t count_cp_utf16_swapped(std::span<const std::uint16_t> s) {
+	return static_cast<std::size_t>(std::ranges::count_if(s, [](std::uint16_t w) { return (w & 0x00FCu) != 0x00DCu; }));
+}
+static std::size_t count_cp_utf32(std::span<const std::uint32_t> s) {
+	return s.size();
+}
+
+// The longest code unit sequence the pred for each encoding form looks at
+constexpr std::size_t max_seq_len(encoding_form e) {
+	return e == encoding_form::utf8 ? 4 : e == encoding_form::utf16le || e == encoding_form::utf16be ? 2 : 1;
+}
+
+// U+FFFD encoded in e
+static std::span<const std::byte> replacement_character(encoding_form e) {
+	static constexpr std::byte u8[] {std::byte {0xEF}, std::byte {0xBF}, std::byte {0xBD}};
+	static constexpr std::byte u16le[] {std::byte {0xFD}, std::byte {0xFF}};
+	static constexpr std::byte u16be[] {std::byte {0xFF}, std::byte {0xFD}};
+	static constexpr std::byte u32le[] {std::byte {0xFD}, std::byte {0xFF}, std::byte {0x00}, std::byte {0x00}};
+	static constexpr std::byte u32be[] {std::byte {0x00}, std::byte {0x00}, std::byte {0xFF}, std::byte {0xFD}};
+	switch (e) {
+		case encoding_form::utf8: return u8;
+		case encoding_form::utf16le: return u16le;
+		case encoding_form::utf16be: return u16be;
+		case encoding_form::utf32le: return u32le;
+		case encoding_form::utf32be: return u32be;
+	}
+	return u8;
+}
+
+
+checker::checker(encoding_form e) : m_enc(e) {
+	//...
+}
+
+const check_result& checker::result() const {
+	return m_result;
+}
+
+void checker::error_at(std::size_t offset, std::vector<std::byte>* sanitized) {
+	++m_result.n_errors;
+	if (!m_result.first_error) {
+		m_result.first_error = offset;
+	}
+	if (sanitized) {
+		std::span<const std::byte> r = replacement_character(m_enc);
+		sanitized->insert(sanitized->end(), r.begin(), r.end());
+	}
+}
+
+// pred has the same contract as begins_with_valid_utf8 & friends; validate as validate_utf8 & friends.
+// count_cp counts the codepoints in a run validate has accepted.  Returns the number of code units
+// consumed.
+template<typename T, typename Pred, typename Validate, typename CountCp>
+std::size_t checker::feed_impl(std::span<const T> s, bool is_last, std::vector<std::byte>* sanitized,
+	Pred pred, Validate validate, CountCp count_cp) {
+	const T* p = s.data();
+	const T* const p_end = s.data() + s.size();
+	// Unless this is the last piece, stop where the remaining code units might be the start of a
+	// sequence truncated by the end of the piece.  The decision made at any position before p_stop
+	// depends only on code units before p_end, so it's the same as if the whole input had been given.
+	const std::size_t n_hold = is_last ? 0 : std::min(s.size(), max_seq_len(m_enc)-1);
+	const T* const p_stop = p_end - n_hold;
+	while (p < p_stop) {
+		// Skip the run of well-formed sequences lying entirely before p_stop in one call.  It ends at an
+		// error or at a sequence straddling p_stop; pred handles the code unit after it.
+		const std::size_t n_valid = validate(std::span<const T>{p,p_stop});
+		if (n_valid > 0) {
+			if (sanitized) {
+				const std::byte* b = reinterpret_cast<const std::byte*>(p);
+				sanitized->insert(sanitized->end(), b, b + n_valid*sizeof(T));
+			}
+			m_result.n_cp += count_cp(std::span<const T>{p,n_valid});
+			p += n_valid;
+			m_in_error = false;
+			continue;
+		}
+		std::optional<int> sz = pred(std::span<const T>{p,p_end});
+		if (sz) {
+			if (sanitized) {
+				const std::byte* b = reinterpret_cast<const std::byte*>(p);
+				sanitized->insert(sanitized->end(), b, b + (*sz)*sizeof(T));
+			}
+			++m_result.n_cp;
+			p += *sz;
+			m_in_error = false;
+			continue;
+		}
+		if (!m_in_error) {
+			error_at(m_result.n_bytes + static_cast<std::size_t>(p-s.data())*sizeof(T), sanitized);
+			m_in_error = true;
+		}
+		++p;
+	}
+	return static_cast<std::size_t>(p-s.data());
+}
+
+std::size_t checker::feed(std::span<const std::byte> s, bool is_last, std::vector<std::byte>* sanitized) {
+	const bool is_native = (std::endian::native == std::endian::little)
+		== (m_enc == encoding_form::utf16le || m_enc == encoding_form::utf32le);
+	const std::size_t cusz = code_unit_size(m_enc);
+	const std::size_t n_cu = s.size()/cusz;
+
+	std::size_t n_cu_consumed {0};
+	if (m_enc == encoding_form::utf8) {
+		std::span<const std::uint8_t> s8 {reinterpret_cast<const std::uint8_t*>(s.data()), n_cu};
+		n_cu_consumed = feed_impl(s8, is_last, sanitized, begins_with_valid_utf8, validate_utf8, count_cp_utf8);
+	} else if (cusz == 2) {
+		std::span<const std::uint16_t> s16 {reinterpret_cast<const std::uint16_t*>(s.data()), n_cu};
+		n_cu_consumed = is_native
+			? feed_impl(s16, is_last, sanitized, begins_with_valid_utf16, validate_utf16, count_cp_utf16)
+			: feed_impl(s16, is_last, sanitized, begins_with_valid_utf16_reversed, validate_utf16_swapped,
+				count_cp_utf16_swapped);
+	} else {
+		std::span<const std::uint32_t> s32 {reinterpret_cast<const std::uint32_t*>(s.data()), n_cu};
+		n_cu_consumed = is_native
+			? feed_impl(s32, is_last, sanitized, begins_with_valid_utf32, validate_utf32, count_cp_utf32)
+			: feed_impl(s32, is_last, sanitized, begins_with_valid_utf32_swapped, validate_utf32_swapped,
+				count_cp_utf32);
+	}
+	std::size_t n_consumed = n_cu_consumed*cusz;
+
+	if (is_last && n_consumed != s.size()) {
+		// Trailing partial code unit
+		error_at(m_result.n_bytes + n_consumed, sanitized);
+		n_consumed = s.size();
+	}
+	m_result.n_bytes += n_consumed;
+	return n_consumed;
+}
+
+check_result check(std::span<const std::byte> s, encoding_form e) {
+	checker c(e);
+	c.feed(s, true);
+	return c.result();
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <optional>
+#include <string_view>
+
+// The encoding forms utfchk can check.  utf-16 and utf-32 come in both byte orders; the one matching
+// the host is read directly and the other is byte-swapped on the fly.
+enum class encoding_form {
+	utf8,
+	utf16le,
+	utf16be,
+	utf32le,
+	utf32be,
+};
+
+std::optional<encoding_form> to_encoding_form(std::string_view name);
+std::string_view to_string(encoding_form e);
+std::size_t code_unit_size(encoding_form e);
+
+struct check_result {
+	std::size_t n_bytes {};
+	std::size_t n_cp {};      // Number of well-formed codepoints
+	std::size_t n_errors {};  // Number of ill-formed subsequences, each counted once regardless of length
+	std::optional<std::size_t> first_error {};  // Byte offset of the first ill-formed subsequence
+
+	bool is_valid() const {
+		return n_errors == 0;
+	}
+};
+
+// Ill-formed subsequences are delimited the way utf_iterator delimits them:  a maximal run of code units
+// none of which begins a well-formed sequence is one error.  If the input size is not a multiple of the
+// code unit size, the leftover bytes at the end are one more error.
+class checker {
+public:
+	explicit checker(encoding_form e);
+
+	// Checks s, which must directly follow the bytes consumed by previous calls.  Returns the number
+	// of bytes of s consumed.  Unless is_last, a few bytes at the end of s (fewer than 8) may be left
+	// unconsumed because they could begin a sequence completed by the next piece; they must be passed
+	// again at the front of the next call.  If is_last, all of s is consumed.
+	// If sanitized is not null, a copy of the consumed input is appended to it with each ill-formed
+	// subsequence replaced by a single U+FFFD in the same encoding form and byte order.
+	std::size_t feed(std::span<const std::byte> s, bool is_last, std::vector<std::byte>* sanitized = nullptr);
+
+	const check_result& result() const;
+private:
+	template<typename T, typename Pred, typename Validate, typename CountCp>
+	std::size_t feed_impl(std::span<const T> s, bool is_last, std::vector<std::byte>* sanitized,
+		Pred pred, Validate validate, CountCp count_cp);
+	void error_at(std::size_t offset, std::vector<std::byte>* sanitized);
+
+	encoding_form m_enc {};
+	check_result m_result {};
+	bool m_in_error {false};
+};
+
+// Checks all of s at once
+check_result check(std::span<const std::byte> s, encoding_form e);
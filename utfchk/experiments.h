@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <span>
+#include <optional>
+#include <filesystem>
+
+// One-off experiments and data generators used during development.  None of these are reachable from
+// the utfchk command line; call them from a scratch main() as needed.
+
+std::string codepoints_bytes_reversed();
+std::string fwd_vs_reverse();
+std::string get_random_utf8_sequences();
+void print_random_utf16_sequences();
+void random_utf8_to_and_from_utf32();
+void random_utf16_to_and_from_utf32();
+void utf8_iterate_sample();
+void utf16_iterate_sample();
+bool random_utf16_file(const std::filesystem::path fp, int nlns, int ncp_ln);
+std::vector<std::uint32_t> random_utf32_to_file(const std::filesystem::path fp, int nlns, int ncp_ln);
+
+struct random_all_encodings {
+	std::vector<std::uint32_t> u32;
+	std::vector<std::uint16_t> u16;
+	std::vector<std::uint8_t> u8;
+};
+random_all_encodings random_codepoints_all_formats_to_files(std::filesystem::path fp, int nlns, int ncp_ln);
+
+std::string u32_to_string(std::span<const std::uint32_t> u32, int max_cpl);
+std::string u16_to_string(std::span<const std::uint16_t> u16, int max_cpl);
+std::string u8_to_string(std::span<const std::uint8_t> u8, int max_cpl);
+std::string split_near_num_chars(const std::string& s, const int n, const char sep);
+
+bool random_utf8_file(const std::filesystem::path& fp, std::size_t n_bytes);
+std::optional<std::size_t> first_invalid_utf8(std::span<const std::uint8_t> s);
+void compare_readfile_and_mmap(const std::filesystem::path& fp);
+
+#ifdef _WIN32
+void random_utf16_wch2multib();
+#endif
@@ -1,413 +1,315 @@
-#include "utflib/utflib.h"
-#include "utflib/byte_manip.h"
-#include "utflib/iterators.h"
-#include "utflib/low_level.h"
-#include "utflib/encoders.h"
+#include "check.h"
+#include "stream.h"
+#include "transcode.h"
 #include "utils.h"
-#include <random>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
 #include <filesystem>
 #include <iostream>
 #include <format>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
 #include <algorithm>
-#include <limits>
-
-
-std::string codepoints_bytes_reversed() {
-	std::string s;
-	std::vector<std::uint32_t> v;
-	for (std::uint32_t i=0; i<std::numeric_limits<std::uint32_t>::max(); ++i) {
-		v.push_back(reverse_bytes(i));
-	}
-	std::ranges::sort(v);
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+
+constexpr std::string_view usage =
+R"(usage: utfchk [options] [path...]
+
+Checks that each file is well-formed in the given encoding form.  Directories are searched
+recursively.  With no paths, or for a path of "-", reads stdin; "-" may be given at most once.  stdin
+is read and checked a block at a time, so it may be arbitrarily long.
+
+options:
+  -e, --encoding <form>  utf8 (default), utf16, utf16le, utf16be, utf32, utf32le or utf32be;
+                         utf16 & utf32 are the host byte order
+  -j, --jobs <n>         check at most n files at a time (default: number of hardware threads)
+  -q, --quiet            print only files that are invalid or unreadable, and the summary
+  -s, --sanitize         copy stdin to stdout, replacing each ill-formed subsequence with U+FFFD
+                         in the same encoding form; the verdict is printed to stderr.  No paths
+                         other than "-" may be given.
+  -b, --block-size <n>   read stdin n bytes at a time (default: 1048576)
+  -t, --to <form>        transcode the input to <form>, replacing each ill-formed subsequence with
+                         U+FFFD, and write the result to the file given by -o.  The input is read
+                         directly off a memory mapping.  Exactly one path, naming a file, must be
+                         given; not compatible with -s.
+  -o, --output <path>    the output file for -t
+  -h, --help             print this message
+
+exit status:  0 if every input is valid, 1 if any is invalid, 2 if any could not be read or on
+a usage error.
+)";
+
+struct options {
+	encoding_form enc {encoding_form::utf8};
+	unsigned n_jobs {};
+	bool quiet {false};
+	bool sanitize {false};
+	std::size_t block_size {1<<20};
+	std::optional<encoding_form> to;
+	std::string output;
+	std::vector<std::string> paths;
+};
 
-	bool was_last_valid {false};
-	for (std::uint32_t i=0; i<std::numeric_limits<std::uint32_t>::max(); ++i) {
-		std::uint32_t i_rev = v[i];//reverse_bytes(i);
-		bool is_valid = is_valid_utf32_codepoint_reversed(i_rev);
-		if (is_valid && !was_last_valid) {
-			s += std::to_string(i_rev);
-			s += " VALID... \n";
-		} else if (!is_valid && was_last_valid) {
-			s += std::to_string(i_rev);
-			s += " INVALID... \n";
+// std::nullopt => print usage & exit
+std::optional<options> parse_args(int argc, char* argv[]) {
+	options opts {};
+	for (int i=1; i<argc; ++i) {
+		std::string_view a {argv[i]};
+		if (a == "-h" || a == "--help") {
+			return std::nullopt;
+		} else if (a == "-q" || a == "--quiet") {
+			opts.quiet = true;
+		} else if (a == "-s" || a == "--sanitize") {
+			opts.sanitize = true;
+		} else if (a == "-b" || a == "--block-size") {
+			if (++i == argc) {
+				return std::nullopt;
+			}
+			long long n = std::atoll(argv[i]);
+			if (n <= 0) {
+				return std::nullopt;
+			}
+			opts.block_size = static_cast<std::size_t>(n);
+		} else if (a == "-e" || a == "--encoding") {
+			if (++i == argc) {
+				return std::nullopt;
+			}
+			std::optional<encoding_form> e = to_encoding_form(argv[i]);
+			if (!e) {
+				return std::nullopt;
+			}
+			opts.enc = *e;
+		} else if (a == "-t" || a == "--to") {
+			if (++i == argc) {
+				return std::nullopt;
+			}
+			opts.to = to_encoding_form(argv[i]);
+			if (!opts.to) {
+				return std::nullopt;
+			}
+		} else if (a == "-o" || a == "--output") {
+			if (++i == argc || *argv[i] == '\0') {
+				return std::nullopt;
+			}
+			opts.output = argv[i];
+		} else if (a == "-j" || a == "--jobs") {
+			if (++i == argc) {
+				return std::nullopt;
+			}
+			int n = std::atoi(argv[i]);
+			if (n <= 0) {
+				return std::nullopt;
+			}
+			opts.n_jobs = static_cast<unsigned>(n);
+		} else if (a.size() > 1 && a[0] == '-') {
+			return std::nullopt;
+		} else {
+			opts.paths.emplace_back(a);
 		}
-		was_last_valid = is_valid;
 	}
-
-	return s;
-}
-
-std::string fwd_vs_reverse() {
-	std::string s;
-	for (std::uint32_t i=0; i<1000; ++i) {
-		s += std::format("{}, {}\n", i, reverse_bytes(i));
+	if (opts.to.has_value() != !opts.output.empty()) {
+		return std::nullopt;
 	}
-	return s;
-}
-
-
-std::string get_random_utf8_sequences() {
-	std::random_device r;
-	std::default_random_engine re(r());
-	int n_sequences = 1;
-	int n_cp = 1024;
-	std::string s;
-
-	for (int i=0; i<n_sequences; ++i) {
-		std::vector<std::uint8_t> v;
-		{
-			// Generate
-			auto it = std::back_inserter(v);
-			it = random_utf8_sequence({0.25,0.25,0.25,0.25}, n_cp, re, it);
-
-			// Validate
-			utf8_iterator u8it(v);
-			while (!u8it.is_finished()) {
-				expect(u8it.get_codepoint().has_value());
-				u8it.go_next();
-			}
-		}
-		for (const std::uint8_t b : v) {
-			s += std::format("{:#04X}, ", b);
-		}
-		std::replace(s.begin(),s.end(),'X','x');
-		s += std::format("\n");
-		v.clear();
+	if (opts.to && (opts.sanitize || opts.paths.size() != 1 || opts.paths[0] == "-")) {
+		return std::nullopt;
 	}
-	return s;
-}
-
-void print_random_utf16_sequences() {
-	std::random_device r;
-	std::default_random_engine re(r());
-	int n_sequences = 20;
-	int n_cp = 10;
-	std::string s;
-
-	for (int i=0; i<n_sequences; ++i) {
-		std::vector<std::uint16_t> v;
-		auto it = std::back_inserter(v);
-		it = random_utf16_sequence({0.5,0.5}, n_cp, re, it);
-		for (const std::uint16_t w : v) {
-			s += std::format("{:#04X}, ", w);
-		}
-		std::replace(s.begin(),s.end(),'X','x');
-		s += std::format("\n");
-		v.clear();
+	if (opts.paths.empty()) {
+		opts.paths.emplace_back("-");
 	}
-	std::cout << s << std::endl;
-}
-
-
-void random_utf8_to_and_from_utf32() {
-	std::random_device r;
-	std::default_random_engine re(r());
-	int n_sequences = 1;
-	int n_cp = 10000;
-
-	for (int i=0; i<n_sequences; ++i) {
-		std::vector<std::uint8_t> ru8;
-		{
-			auto it = std::back_inserter(ru8);
-			it = random_utf8_sequence({0.25,0.25,0.25,0.25}, n_cp, re, it);
-		}
-
-		std::vector<std::uint32_t> ru32;
-		ru32.reserve(n_cp);
-		{
-			utf8_iterator u8it(ru8);
-			while (!u8it.is_finished()) {
-				expect(u8it.get_codepoint().has_value());
-				std::uint32_t cp = u8it.get_codepoint().value().get();
-				expect(is_valid_cp(cp));
-				ru32.push_back(cp);
-				u8it.go_next();
-			}
-		}
-		
-		std::vector<std::uint8_t> ru8_back;
-		auto ru8_back_it = std::back_inserter(ru8_back);
-		for (const std::uint32_t curr_u32 : ru32) {
-			ru8_back_it = to_utf8(curr_u32,ru8_back_it);
-		}
-		expect(ru8_back.size()==ru8.size());
-		for (std::size_t i=0; i<ru8.size(); ++i) {
-			expect(ru8[i]==ru8_back[i]);
-		}
+	// stdin can only be read once
+	if (std::ranges::count(opts.paths, std::string("-")) > 1) {
+		return std::nullopt;
 	}
-	return;
-}
-
-void random_utf16_to_and_from_utf32() {
-	std::random_device r;
-	std::default_random_engine re(r());
-	int n_sequences = 10000;
-	int n_cp = 1000;  // num codepoints per sequence
-
-	for (int i=0; i<n_sequences; ++i) {
-		std::vector<std::uint16_t> random_utf16;
-		{
-			auto it = std::back_inserter(random_utf16);
-			it = random_utf16_sequence({0.5,0.5}, n_cp, re, it);
-		}
-
-		std::vector<std::uint32_t> random_utf32_from_random_utf16;
-		utf16_iterator u16it(random_utf16);
-		while (!u16it.is_finished()) {
-			std::optional<codepoint> ocp = u16it.get_codepoint();
-			expect(ocp.has_value());
-			std::int32_t cp = ocp->get();
-			random_utf32_from_random_utf16.push_back(cp);
-			u16it.go_next();
-		}
-		expect(random_utf32_from_random_utf16.size()==n_cp);
-
-		std::vector<std::uint16_t> random_utf16_from_random_utf32;
-		auto it = std::back_inserter(random_utf16_from_random_utf32);
-		for (const std::uint32_t cp : random_utf32_from_random_utf16) {
-			it = to_utf16(cp, it);
-		}
-
-		// Validate that the back-calculated utf16 is what was generated initially
-		expect(random_utf16.size() == random_utf16_from_random_utf32.size());
-		for (int j=0; j<random_utf16.size(); ++j) {
-			expect(random_utf16[j] == random_utf16_from_random_utf32[j]);
-		}
+	if (opts.sanitize && std::ranges::any_of(opts.paths, [](const std::string& p) { return p != "-"; })) {
+		return std::nullopt;
+	}
+	if (opts.n_jobs == 0) {
+		opts.n_jobs = std::max(1u, std::thread::hardware_concurrency());
 	}
+	return opts;
 }
 
-void utf8_iterate_sample() {
-	//std::vector<std::uint8_t> u8data   {0xF0, 0x9F, 0x99, 0x83, 0x61, 0xED, 0xEE, 0xF0, 0xF0, 0x9F, 0x98, 0x80, 0x64, 0x65, 0x66};
-	//std::vector<std::uint32_t> u32data {0x1F643,                0x61, 0xFFFD,           0x1F600,                0x64, 0x65, 0x66};
-	std::vector<std::uint8_t> u8data   {0xF0, 0x9F, 0x99, 0x93};
-	std::vector<std::uint32_t> u32data {0xFFFD,               };
-
-
-	utf8_iterator it(u8data);
-	std::size_t idx_u32 {0};
-	while (!it.is_finished()) {
-		std::optional<codepoint> ocp = it.get_codepoint();
-		if (ocp) {
-			bool b = ocp->get() == u32data[idx_u32];
+// Expands directories into the regular files beneath them, in sorted order so that the output is
+// stable from run to run.  Paths that don't exist are passed through; they are reported as unreadable.
+// If the walk of a directory fails part way (ex ELOOP, or an entry removed during the walk), the last
+// entry reached is passed through the same way and the rest of the walk is skipped, since the iterator
+// can't be advanced past an error.
+std::vector<std::filesystem::path> collect_inputs(const std::vector<std::string>& paths) {
+	std::vector<std::filesystem::path> inputs;
+	for (const std::string& p : paths) {
+		std::error_code ec;
+		if (p != "-" && std::filesystem::is_directory(p, ec)) {
+			std::vector<std::filesystem::path> in_dir;
+			auto opt = std::filesystem::directory_options::skip_permission_denied;
+			std::filesystem::recursive_directory_iterator it(p, opt, ec);
+			if (ec) {
+				in_dir.emplace_back(p);
+			}
+			while (!ec && it != std::filesystem::recursive_directory_iterator()) {
+				std::error_code ec_type;
+				if (it->is_regular_file(ec_type)) {
+					in_dir.push_back(it->path());
+				}
+				std::filesystem::path curr = it->path();
+				it.increment(ec);
+				if (ec) {
+					in_dir.push_back(std::move(curr));
+				}
+			}
+			std::ranges::sort(in_dir);
+			inputs.insert(inputs.end(), in_dir.begin(), in_dir.end());
 		} else {
-			bool b = u32data[idx_u32] == 0xFFFD;
+			inputs.emplace_back(p);
 		}
-		it.go_next();
-		++idx_u32;
 	}
+	return inputs;
 }
 
-void utf16_iterate_sample() {
-	std::vector<std::uint16_t> u16 {0xdba3u, 0xdd63u};
+struct file_verdict {
+	std::optional<check_result> result;  // Empty => the input could not be read
+	bool is_done {false};
+};
 
-	std::vector<std::uint32_t> u32;
-	utf16_iterator u16it(u16);
-	while (!u16it.is_finished()) {
-		std::optional<codepoint> ocp = u16it.get_codepoint();
-		expect(ocp.has_value());
-		std::int32_t cp = ocp->get();
-		u32.push_back(cp);
-		u16it.go_next();
+file_verdict check_input(const std::filesystem::path& fp, const options& opts) {
+	if (fp == "-") {
+		return {check_stream(stdin, opts.sanitize ? stdout : nullptr, opts.enc, opts.block_size), true};
 	}
-
-	return;
+	mapped_file f(fp);
+	if (f.is_open()) {
+		return {check(f.data(), opts.enc), true};
+	}
+	// Not a regular file, ex a named pipe, <(cmd) or /dev/stdin, or one that can't be mapped:  read it
+	// as a stream like stdin
+	file_raii in = std::fopen(fp.string().c_str(), "rb");
+	if (!in) {
+		return {std::nullopt, true};
+	}
+	return {check_stream(in, nullptr, opts.enc, opts.block_size), true};
 }
 
-bool random_utf16_file(const std::filesystem::path fp, int nlns, int ncp_ln) {
-	std::random_device r;
-	std::default_random_engine re(r());
-
-	std::vector<std::uint16_t> u16;
-	for (int i=0; i<nlns; ++i) {
-		auto it = std::back_inserter(u16);
-		it = random_utf16_sequence({0.5,0.5}, ncp_ln, re, it);
-		*it = std::uint16_t {0xAu};
+std::string format_verdict(const std::filesystem::path& fp, const file_verdict& v) {
+	std::string name = fp == "-" ? std::string("<stdin>") : fp.string();
+	if (!v.result) {
+		return std::format("{}: unreadable\n", name);
 	}
-
-	const std::byte* p = reinterpret_cast<const std::byte*>(u16.data());
-	std::size_t nbytes = (sizeof(std::uint16_t)/sizeof(std::byte))*u16.size();
-	return writefile(fp, {p, nbytes});
+	const check_result& r = *v.result;
+	if (r.is_valid()) {
+		return std::format("{}: valid, {} codepoints, {} bytes\n", name, r.n_cp, r.n_bytes);
+	}
+	return std::format("{}: invalid, first error at byte {}, {} ill-formed subsequences, {} codepoints, {} bytes\n",
+		name, *r.first_error, r.n_errors, r.n_cp, r.n_bytes);
 }
 
-std::vector<std::uint32_t> random_utf32_to_file(const std::filesystem::path fp, int nlns, int ncp_ln) {
-	std::random_device r;
-	std::default_random_engine re(r());
-
-	std::vector<std::uint32_t> ru32;
-	for (int i=0; i<nlns; ++i) {
-		auto it = std::back_inserter(ru32);
-		it = random_utf32_sequence(ncp_ln, re, it);
-		*it = std::uint32_t {0x0Au};
+// -t:  checks the input, then transcodes it to opts.output.  Both passes read the same mapping.
+int transcode_input(const options& opts) {
+	const std::filesystem::path fp {opts.paths[0]};
+	mapped_file f(fp);
+	if (!f.is_open()) {
+		std::cout << format_verdict(fp, file_verdict {std::nullopt, true});
+		return 2;
 	}
-
-	const std::byte* p = reinterpret_cast<const std::byte*>(ru32.data());
-	std::size_t nbytes = (sizeof(std::uint32_t)/sizeof(std::byte))*ru32.size();
-	writefile(fp, {p, nbytes});
-	return ru32;
+	const check_result r = check(f.data(), opts.enc);
+	std::cout << format_verdict(fp, file_verdict {r, true});
+	file_raii out = std::fopen(opts.output.c_str(), "wb");
+	if (!out || !transcode(f.data(), opts.enc, *opts.to, out) || std::fflush(out) != 0) {
+		std::cerr << std::format("{}: could not write\n", opts.output);
+		return 2;
+	}
+	return r.is_valid() ? 0 : 1;
 }
 
-struct random_all_encodings {
-	std::vector<std::uint32_t> u32;
-	std::vector<std::uint16_t> u16;
-	std::vector<std::uint8_t> u8;
-};
-random_all_encodings random_codepoints_all_formats_to_files(std::filesystem::path fp, int nlns, int ncp_ln) {
-	std::string file_name_no_ext = fp.stem().string();
-	std::string file_name_ext = fp.extension().string();
-
-	// Generate utf32 & write file
-	std::vector<std::uint32_t> ru32 = random_utf32_to_file(fp, nlns, ncp_ln);
 
-	// Encode the random utf32 -> utf8
-	std::filesystem::path u8_fp = fp.replace_filename(file_name_no_ext+"_u8"+file_name_ext);
-	std::vector<std::uint8_t> ru8;
-	auto it_u8 = std::back_inserter(ru8);
-	for (std::uint32_t cp : ru32) {
-		it_u8 = to_utf8(cp, it_u8);
-	}
-	bool success_u8 = writefile(u8_fp,{reinterpret_cast<std::byte*>(ru8.data()), ru8.size()});
-	expect(success_u8);
-	if (!success_u8) {
-		return {};
+int main(int argc, char* argv[]) {
+	std::optional<options> opts = parse_args(argc, argv);
+	if (!opts) {
+		std::cerr << usage;
+		return 2;
 	}
-
-	// Encode the random utf32 -> utf16
-	std::filesystem::path u16_fp = fp.replace_filename(file_name_no_ext+"_u16"+file_name_ext);
-	std::vector<std::uint16_t> ru16;
-	auto it_u16 = std::back_inserter(ru16);
-	for (std::uint32_t cp : ru32) {
-		it_u16 = to_utf16(cp, it_u16);
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	if (opts->to) {
+		return transcode_input(*opts);
 	}
-	std::size_t nbytes_16 = (sizeof(std::uint16_t)/sizeof(std::byte))*ru16.size();
-	bool success_u16 = writefile(u16_fp,{reinterpret_cast<std::byte*>(ru16.data()), nbytes_16});
-	expect(success_u16);
-	if (!success_u16) {
-		return {};
+	if (opts->sanitize) {
+		// Unbuffered, so that each fwrite() of a block of sanitized output is a single write
+		std::setvbuf(stdout, nullptr, _IONBF, 0);
 	}
-
-	return random_all_encodings {std::move(ru32), std::move(ru16), std::move(ru8)};
-}
-
-std::string u32_to_string(std::span<const std::uint32_t> u32, int max_cpl) {
-	std::string s;
-	s.reserve(u32.size());
-	int curr_cpl {0};
-	for (const std::uint32_t dw : u32) {
-		constexpr int cpe = 10;  // chars per entry
-		s += std::format("{:#08X}u, ", dw);
-		curr_cpl += cpe;
-		if (curr_cpl > (max_cpl-cpe)) {
-			curr_cpl = 0;
-			s.back() = '\n';  // replaces the ' ' after the  ','
+	// When stdout carries the sanitized data the verdicts go to stderr
+	std::ostream& verdict_out = opts->sanitize ? std::cerr : std::cout;
+	std::vector<std::filesystem::path> inputs = collect_inputs(opts->paths);
+
+	// Workers take the next unclaimed input; verdicts are printed in input order as soon as every
+	// input before them is done.
+	std::vector<file_verdict> verdicts(inputs.size());
+	std::atomic<std::size_t> next_input {0};
+	std::size_t next_print {0};
+	std::mutex mtx;
+
+	auto worker = [&]() {
+		while (true) {
+			std::size_t i = next_input.fetch_add(1);
+			if (i >= inputs.size()) {
+				break;
+			}
+			file_verdict v = check_input(inputs[i], *opts);
+			std::scoped_lock lck(mtx);
+			verdicts[i] = std::move(v);
+			while (next_print < verdicts.size() && verdicts[next_print].is_done) {
+				const file_verdict& curr = verdicts[next_print];
+				if (!opts->quiet || !curr.result || !curr.result->is_valid()) {
+					verdict_out << format_verdict(inputs[next_print], curr);
+				}
+				++next_print;
+			}
 		}
-	}
-	std::replace(s.begin(),s.end(),'X','x');
-	s += std::format("\n");
-	return s;
-}
+	};
 
-std::string u16_to_string(std::span<const std::uint16_t> u16, int max_cpl) {
-	std::string s;
-	s.reserve(u16.size());
-	int curr_cpl {0};
-	for (const std::uint16_t w : u16) {
-		constexpr int cpe = 8;  // chars per entry
-		s += std::format("{:#06X}u, ", w);
-		curr_cpl += cpe;
-		if (curr_cpl > (max_cpl-cpe)) {
-			curr_cpl = 0;
-			s.back() = '\n';  // replaces the ' ' after the  ','
+	auto t0 = std::chrono::steady_clock::now();
+	{
+		std::vector<std::jthread> pool;
+		unsigned n_threads = std::min<std::size_t>(opts->n_jobs, inputs.size());
+		for (unsigned i=0; i<n_threads; ++i) {
+			pool.emplace_back(worker);
 		}
 	}
-	std::replace(s.begin(),s.end(),'X','x');
-	s += std::format("\n");
-	return s;
-}
-
-std::string u8_to_string(std::span<const std::uint8_t> u8, int max_cpl) {
-	std::string s;
-	s.reserve(u8.size());
-	int curr_cpl {0};
-	for (const std::uint8_t b : u8) {
-		constexpr int cpe = 6;  // chars per entry
-		s += std::format("{:#04X}u, ", b);
-		curr_cpl += cpe;
-		if (curr_cpl > (max_cpl-cpe)) {
-			curr_cpl = 0;
-			s.back() = '\n';  // replaces the ' ' after the  ','
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+	verdict_out.flush();
+
+	std::size_t n_invalid {0};
+	std::size_t n_unreadable {0};
+	std::size_t n_bytes {0};
+	for (const file_verdict& v : verdicts) {
+		if (!v.result) {
+			++n_unreadable;
+			continue;
 		}
+		n_invalid += !v.result->is_valid();
+		n_bytes += v.result->n_bytes;
 	}
-	std::replace(s.begin(),s.end(),'X','x');
-	s += std::format("\n");
-	return s;
-}
-
-std::string split_near_num_chars(const std::string& s, const int n, const char sep) {
-	std::string r;
-	r.reserve(s.size() + s.size()/n + 1);
-	auto it = s.cbegin();
-	while (it != s.cend()) {
-		int i=0;
-		while (it!=s.cend() && (i<n || *it!=sep)) {
-			r.push_back(*it);
-			++it;
-			++i;
-		}
-		if (it==s.cend()) { break; }
+	double gb = static_cast<double>(n_bytes)/1e9;
+	std::cerr << std::format("{} files, {} invalid, {} unreadable; {:.3f} GB in {:.3f} s ({:.3f} GB/s)\n",
+		inputs.size(), n_invalid, n_unreadable, gb, secs, secs > 0 ? gb/secs : 0.0);
 
-		// i>=n && *it==sep
-		r.push_back('\n');
-		++it;  // skip the sep char
-		i = 0;
+	if (n_unreadable > 0) {
+		return 2;
 	}
-	return r;
-}
-
-
-void random_utf16_wch2multib();
-
-
-int main(int argc, char* argv[]) {
-	/*if (argc != 2) {
-		std::cout << "Expected a file path" << std::endl;
+	if (n_invalid > 0) {
 		return 1;
-	}*/
-
-	{
-		//std::cout << codepoints_bytes_reversed() << std::endl;
-		//std::cout << fwd_vs_reverse() << std::endl;
 	}
-
-	/*{
-		random_all_encodings rcps = random_codepoints_all_formats_to_files("D:\\dev\\utflib\\data\\rcps.txt", 500, 20);
-		std::cout << u32_to_string(rcps.u32, 90) << "\n\n";
-		std::cout << u16_to_string(rcps.u16, 90) << "\n\n";
-		std::cout << u8_to_string(rcps.u8, 90) << "\n\n";
-		std::cout << std::endl;
-		std::cout << std::endl;
-	}*/
-
-	//random_utf16_wch2multib();
-	//utf16_iterate_sample();
-	//random_utf16_to_and_from_utf32();
-	
-	//std::string ru8 = get_random_utf8_sequences();
-	//std::cout << split_near_num_chars(ru8,81,' ');
-	
-	//print_random_utf16_sequences();
-	//random_utf8_to_and_from_utf32();
-	//iterate_sample();
-	//random_utf16_file("D:\\dev\\utflib\\ru16.txt", 1, 10);
-	
-
-	/*std::filesystem::path file{argv[1]};
-	std::vector<std::byte> file_data = readfile(file);
-	std::span<const char> s {reinterpret_cast<const char*>(file_data.data()), file_data.size()};
-	bool b = utfchk(s);*/
-
-	//f();
-
-
 	return 0;
 }
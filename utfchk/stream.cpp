@@ -0,0 +1,82 @@
+#include "stream.h"
+
+#include "check.h"
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <array>
+#include <optional>
+#include <semaphore>
+#include <thread>
+
+
+std::optional<check_result> check_stream(std::FILE* in, std::FILE* out, encoding_form e, std::size_t block_size) {
+	// Each buffer has room in front of the block for the bytes a checker leaves unconsumed at the end of
+	// the previous block (always fewer than 8).  Keeping block_size a multiple of 8 keeps the start of
+	// the carried-over bytes aligned for the code unit type.
+	constexpr std::size_t n_carry_max = 8;
+	block_size = block_size < n_carry_max ? n_carry_max : block_size - block_size%n_carry_max;
+
+	struct block {
+		std::vector<std::byte> d;
+		std::size_t n_read {};
+		bool is_last {};
+		bool is_error {};
+	};
+	std::array<block,2> blocks;
+	for (block& b : blocks) {
+		b.d.resize(n_carry_max + block_size);
+	}
+	std::counting_semaphore<2> n_empty {2};
+	std::counting_semaphore<2> n_full {0};
+
+	std::jthread reader([&]() {
+		for (std::size_t i=0; ; ++i) {
+			n_empty.acquire();
+			block& b = blocks[i%2];
+			b.n_read = std::fread(b.d.data()+n_carry_max, 1, block_size, in);
+			b.is_error = std::ferror(in) != 0;
+			b.is_last = b.n_read < block_size;
+			bool is_done = b.is_last;
+			n_full.release();
+			if (is_done) {
+				break;
+			}
+		}
+	});
+
+	checker c(e);
+	std::vector<std::byte> sanitized;
+	sanitized.reserve(3*(block_size + n_carry_max));  // Worst case:  a 3-byte U+FFFD for each input byte
+	std::array<std::byte,n_carry_max> carry {};
+	std::size_t n_carry {0};
+	bool is_ok {true};
+	for (std::size_t i=0; ; ++i) {
+		n_full.acquire();
+		block& b = blocks[i%2];
+		std::byte* p = b.d.data() + n_carry_max - n_carry;
+		std::memcpy(p, carry.data(), n_carry);
+		std::size_t n = n_carry + b.n_read;
+		bool is_last = b.is_last;
+		is_ok = is_ok && !b.is_error;
+
+		sanitized.clear();
+		std::size_t n_consumed = c.feed({p,n}, is_last, out ? &sanitized : nullptr);
+		n_carry = n - n_consumed;
+		std::memcpy(carry.data(), p + n_consumed, n_carry);
+		n_empty.release();
+
+		if (out && !sanitized.empty()) {
+			is_ok = is_ok && std::fwrite(sanitized.data(), 1, sanitized.size(), out) == sanitized.size();
+		}
+		if (is_last) {
+			break;
+		}
+	}
+
+	if (!is_ok) {
+		return std::nullopt;
+	}
+	return c.result();
+}
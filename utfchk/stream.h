@@ -0,0 +1,11 @@
+#pragma once
+#include "check.h"
+#include <cstdio>
+#include <cstddef>
+
+// Checks everything readable from in, block_size bytes at a time, and, if out is not null, writes a
+// sanitized copy of the input to it (see checker::feed).  The next block is read on a second thread
+// while the current one is checked, and the output for each block is written with a single fwrite().
+// Memory use is a small multiple of block_size regardless of how much is read.
+// Returns std::nullopt if a read or write fails.
+std::optional<check_result> check_stream(std::FILE* in, std::FILE* out, encoding_form e, std::size_t block_size);
@@ -0,0 +1,104 @@
+#include "transcode.h"
+
+#include "check.h"
+#include "utflib/utflib.h"
+#include "utflib/iterators.h"
+#include "utflib/byte_manip.h"
+#include "utflib/encoders.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <bit>
+#include <vector>
+#include <optional>
+
+
+static bool is_host_byte_order(encoding_form e) {
+	return (std::endian::native == std::endian::little)
+		== (e == encoding_form::utf16le || e == encoding_form::utf32le);
+}
+
+// Writes the encoding of cp in the form To at p; returns one past the last byte written.  There must
+// be room for 4 bytes at p.
+template<encoding_form To>
+static std::byte* encode(codepoint cp, std::byte* p) {
+	if constexpr (To == encoding_form::utf8) {
+		std::uint8_t b[4];
+		const std::size_t n = encode_utf8(cp, b) - b;
+		std::memcpy(p, b, n);
+		return p + n;
+	} else if constexpr (To == encoding_form::utf16le || To == encoding_form::utf16be) {
+		std::uint16_t w[2];
+		const std::size_t n = encode_utf16(cp, w) - w;
+		if (!is_host_byte_order(To)) {
+			w[0] = reverse_bytes(w[0]);
+			w[1] = reverse_bytes(w[1]);
+		}
+		std::memcpy(p, w, n*sizeof(std::uint16_t));
+		return p + n*sizeof(std::uint16_t);
+	} else {
+		std::uint32_t v = cp.get();
+		if (!is_host_byte_order(To)) {
+			v = reverse_bytes(v);
+		}
+		std::memcpy(p, &v, sizeof(v));
+		return p + sizeof(v);
+	}
+}
+
+template<typename It, encoding_form To, typename T>
+static bool transcode_impl(std::span<const T> s, bool has_partial_code_unit, std::FILE* out) {
+	const codepoint replacement = codepoint::to_codepoint_unchecked(0xFFFDu);
+	std::vector<std::byte> buf(1<<16);
+	std::byte* p = buf.data();
+	std::byte* const p_flush = buf.data() + buf.size() - 4;
+	auto flush = [&]() {
+		const std::size_t n = static_cast<std::size_t>(p - buf.data());
+		p = buf.data();
+		return std::fwrite(buf.data(), 1, n, out) == n;
+	};
+
+	for (It it {s}; !it.is_finished(); it.go_next()) {
+		const std::optional<codepoint> cp = it.get_codepoint();
+		p = encode<To>(cp ? *cp : replacement, p);
+		if (p >= p_flush && !flush()) {
+			return false;
+		}
+	}
+	if (has_partial_code_unit) {
+		p = encode<To>(replacement, p);
+	}
+	return flush();
+}
+
+// Selects the iterator for the input form
+template<encoding_form To>
+static bool transcode_to(std::span<const std::byte> s, encoding_form from, std::FILE* out) {
+	const std::size_t cusz = code_unit_size(from);
+	const std::size_t n_cu = s.size()/cusz;
+	const bool has_partial = s.size()%cusz != 0;
+	if (from == encoding_form::utf8) {
+		std::span<const std::uint8_t> s8 {reinterpret_cast<const std::uint8_t*>(s.data()), n_cu};
+		return transcode_impl<utf8_iterator,To>(s8, has_partial, out);
+	} else if (cusz == 2) {
+		std::span<const std::uint16_t> s16 {reinterpret_cast<const std::uint16_t*>(s.data()), n_cu};
+		return is_host_byte_order(from) ? transcode_impl<utf16_iterator,To>(s16, has_partial, out)
+			: transcode_impl<utf16_iterator_swapping,To>(s16, has_partial, out);
+	}
+	std::span<const std::uint32_t> s32 {reinterpret_cast<const std::uint32_t*>(s.data()), n_cu};
+	return is_host_byte_order(from) ? transcode_impl<utf32_iterator,To>(s32, has_partial, out)
+		: transcode_impl<utf32_iterator_swapping,To>(s32, has_partial, out);
+}
+
+bool transcode(std::span<const std::byte> s, encoding_form from, encoding_form to, std::FILE* out) {
+	switch (to) {
+		case encoding_form::utf8: return transcode_to<encoding_form::utf8>(s, from, out);
+		case encoding_form::utf16le: return transcode_to<encoding_form::utf16le>(s, from, out);
+		case encoding_form::utf16be: return transcode_to<encoding_form::utf16be>(s, from, out);
+		case encoding_form::utf32le: return transcode_to<encoding_form::utf32le>(s, from, out);
+		case encoding_form::utf32be: return transcode_to<encoding_form::utf32be>(s, from, out);
+	}
+	return false;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "check.h"
+#include <cstdio>
+#include <cstddef>
+#include <span>
+
+// Transcodes s from one encoding form to another and writes the result to out, replacing each
+// ill-formed subsequence (delimited as by checker) w/ a single U+FFFD.  s is read in place, ex directly
+// off a mapped_file; the output is staged in a fixed-size buffer, so memory use does not grow with the
+// size of the input.  Returns false if a write fails.
+bool transcode(std::span<const std::byte> s, encoding_form from, encoding_form to, std::FILE* out);
@@ -5,6 +5,21 @@
 #include <filesystem>
 #include <cstdio>
 #include <span>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 std::vector<std::byte> readfile(const std::filesystem::path& fp) {
 	std::vector<std::byte> file_data;
@@ -32,25 +47,6 @@ std::vector<std::byte> readfile(const std::filesystem::path& fp) {
 
 // Overwrites the file if it already exists
 bool writefile(const std::filesystem::path& fp, std::span<const std::byte> data) {
-	class file_raii {
-	public:
-		file_raii(std::FILE* fp) : m_fp(fp) {}
-		~file_raii() {
-			if (m_fp) {
-				std::fclose(m_fp);
-				m_fp = nullptr;
-			}
-		}
-		operator bool() const {
-			return m_fp;
-		}
-		operator std::FILE*() {
-			return m_fp;
-		}
-	private:
-		std::FILE* m_fp {};
-	};
-
 	file_raii f = std::fopen(fp.string().c_str(), "wb");
 	if (!f) {
 		return false;
@@ -63,3 +59,157 @@ bool writefile(const std::filesystem::path& fp, std::span<const std::byte> data)
 
 	return true;
 }
+
+
+//
+// mapped_file
+//
+#ifdef _WIN32
+mapped_file::mapped_file(const std::filesystem::path& fp) {
+	HANDLE hfile = CreateFileW(fp.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hfile == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	m_hfile = hfile;
+	LARGE_INTEGER sz {};
+	if (!GetFileSizeEx(hfile, &sz)) {
+		close();
+		return;
+	}
+	m_sz = static_cast<std::size_t>(sz.QuadPart);
+	if (m_sz == 0) {
+		m_is_open = true;  // CreateFileMapping refuses to map an empty file
+		return;
+	}
+	m_hmap = CreateFileMappingW(hfile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_hmap) {
+		close();
+		return;
+	}
+	m_p = static_cast<const std::byte*>(MapViewOfFile(m_hmap, FILE_MAP_READ, 0, 0, 0));
+	if (!m_p) {
+		close();
+		return;
+	}
+	// Large pages are not available for file-backed views; FILE_FLAG_SEQUENTIAL_SCAN is the only hint.
+	m_is_open = true;
+}
+
+void mapped_file::close() {
+	if (m_p) {
+		UnmapViewOfFile(m_p);
+	}
+	if (m_hmap) {
+		CloseHandle(m_hmap);
+	}
+	if (m_hfile) {
+		CloseHandle(m_hfile);
+	}
+	m_p = nullptr;
+	m_sz = 0;
+	m_hmap = nullptr;
+	m_hfile = nullptr;
+	m_is_open = false;
+}
+#else
+mapped_file::mapped_file(const std::filesystem::path& fp) {
+	int fd = ::open(fp.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return;
+	}
+	struct stat st {};
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		::close(fd);
+		return;
+	}
+	m_sz = static_cast<std::size_t>(st.st_size);
+	if (m_sz == 0) {
+		::close(fd);
+		m_is_open = true;  // mmap refuses a length of 0
+		return;
+	}
+	void* p = ::mmap(nullptr, m_sz, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);  // The mapping holds its own reference to the file
+	if (p == MAP_FAILED) {
+		m_sz = 0;
+		return;
+	}
+	// Hints only; failure is harmless.  MADV_HUGEPAGE on a file mapping is honored only by kernels
+	// built with CONFIG_READ_ONLY_THP_FOR_FS.
+	::madvise(p, m_sz, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+	::madvise(p, m_sz, MADV_HUGEPAGE);
+#endif
+	m_p = static_cast<const std::byte*>(p);
+	m_is_open = true;
+}
+
+void mapped_file::close() {
+	if (m_p) {
+		::munmap(const_cast<std::byte*>(m_p), m_sz);
+	}
+	m_p = nullptr;
+	m_sz = 0;
+	m_is_open = false;
+}
+#endif
+
+mapped_file::~mapped_file() {
+	close();
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept {
+	*this = std::move(other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+	close();
+	m_p = std::exchange(other.m_p, nullptr);
+	m_sz = std::exchange(other.m_sz, 0);
+	m_is_open = std::exchange(other.m_is_open, false);
+#ifdef _WIN32
+	m_hfile = std::exchange(other.m_hfile, nullptr);
+	m_hmap = std::exchange(other.m_hmap, nullptr);
+#endif
+	return *this;
+}
+
+bool mapped_file::is_open() const {
+	return m_is_open;
+}
+
+std::span<const std::byte> mapped_file::data() const {
+	return {m_p, m_sz};
+}
+
+
+rss_info current_rss() {
+	rss_info r {};
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc {};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+		r.total = pmc.WorkingSetSize;
+	}
+#else
+	// Lines look like "RssAnon:	    1234 kB"
+	std::ifstream f("/proc/self/status");
+	std::string ln;
+	while (std::getline(f, ln)) {
+		auto kb = [&ln](std::string_view key) -> std::size_t {
+			return std::stoull(ln.substr(key.size()))*1024;
+		};
+		if (ln.starts_with("VmRSS:")) {
+			r.total = kb("VmRSS:");
+		} else if (ln.starts_with("RssAnon:")) {
+			r.anon = kb("RssAnon:");
+		} else if (ln.starts_with("RssFile:")) {
+			r.file = kb("RssFile:");
+		}
+	}
+#endif
+	return r;
+}
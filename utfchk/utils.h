@@ -1,17 +1,82 @@
 #pragma once
 #include "utflib/utflib.h"
 #include "utflib/low_level.h"
+#include "utflib/encoders.h"
 #include <vector>
 #include <filesystem>
 #include <cstdint>
 #include <random>
 #include <span>
+#include <cstdio>
+#include <cstddef>
 
 std::vector<std::byte> readfile(const std::filesystem::path& fp);
 
 // Overwrites the file if it already exists
 bool writefile(const std::filesystem::path& fp, std::span<const std::byte> data);
 
+class file_raii {
+public:
+	file_raii(std::FILE* fp) : m_fp(fp) {}
+	~file_raii() {
+		if (m_fp) {
+			std::fclose(m_fp);
+			m_fp = nullptr;
+		}
+	}
+	file_raii(const file_raii&) = delete;
+	file_raii& operator=(const file_raii&) = delete;
+	operator bool() const {
+		return m_fp;
+	}
+	operator std::FILE*() {
+		return m_fp;
+	}
+private:
+	std::FILE* m_fp {};
+};
+
+
+// A read-only mapping of an entire file.  Unlike readfile() nothing is copied:  pages are faulted in
+// from the page cache as they are touched, so the file does not need to fit in memory twice (or at
+// all).  The OS is told the mapping will be read front-to-back and, where the platform supports it,
+// asked to back it with huge pages.
+// If the file can't be opened or mapped, is_open() is false and data() is empty.  An empty file is
+// open and has empty data().
+class mapped_file {
+public:
+	mapped_file() = default;
+	explicit mapped_file(const std::filesystem::path& fp);
+	~mapped_file();
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+	mapped_file(mapped_file&&) noexcept;
+	mapped_file& operator=(mapped_file&&) noexcept;
+
+	bool is_open() const;
+	std::span<const std::byte> data() const;
+private:
+	void close();
+
+	const std::byte* m_p {};
+	std::size_t m_sz {};
+	bool m_is_open {false};
+#ifdef _WIN32
+	void* m_hfile {};
+	void* m_hmap {};
+#endif
+};
+
+
+// Resident memory of this process.  anon is memory not backed by a file (the heap, stacks); file is
+// memory backed by mapped files, including mapped_file.  Fields the platform doesn't expose are 0.
+struct rss_info {
+	std::size_t total {};
+	std::size_t anon {};
+	std::size_t file {};
+};
+rss_info current_rss();
+
 
 
 struct utf8_subseq_len_probability {
@@ -107,3 +172,74 @@ OIt random_utf32_sequence(int n_cp, std::default_random_engine& re, OIt out) {
 	return out;
 }
 
+
+
+// A crude model of running text in one or more scripts, for benchmark corpora (see
+// benchmarks/corpus_gen.cpp).  Uniformly random codepoints almost never hit ascii and never form words;
+// here, words are runs of codepoints drawn from the ranges in letters, each range chosen w/ probability
+// proportional to its weight.  Words are separated by word_sep (0 => none, as in CJK), occasionally
+// followed by a character from punct, and lines end w/ 0x0A.
+struct codepoint_range {
+	std::uint32_t first {};
+	std::uint32_t last {};  // Inclusive
+	double weight {1.0};
+};
+struct utf8_text_model {
+	std::vector<codepoint_range> letters;
+	std::vector<std::uint32_t> punct {0x2Cu, 0x2Eu};
+	double p_punct {0.1};
+	int min_word_len {1};
+	int max_word_len {8};
+	std::uint32_t word_sep {0x20u};
+	int min_words_per_line {4};
+	int max_words_per_line {16};
+	bool log_prefix {false};  // Begin each line w/ an ascii timestamp and level, as in a log file
+};
+
+// Writes one line, including the terminating 0x0A
+template<typename OIt>
+OIt random_utf8_text_line(const utf8_text_model& m, std::default_random_engine& re, OIt out) {
+	std::vector<double> weights;
+	for (const auto& r : m.letters) {
+		weights.push_back(r.weight);
+	}
+	std::discrete_distribution<std::size_t> range_dist(weights.begin(), weights.end());
+	std::uniform_int_distribution<int> word_len_dist(m.min_word_len, m.max_word_len);
+	std::uniform_int_distribution<int> n_words_dist(m.min_words_per_line, m.max_words_per_line);
+	std::bernoulli_distribution punct_dist(m.punct.empty() ? 0.0 : m.p_punct);
+
+	if (m.log_prefix) {
+		constexpr const char* levels[] {"DEBUG", "INFO ", "INFO ", "INFO ", "WARN ", "ERROR"};
+		std::uniform_int_distribution<int> level_dist(0, 5);
+		std::uniform_int_distribution<int> d(0, 999);
+		char buf[64] {};
+		int n = std::snprintf(buf, sizeof(buf), "2025-%02d-%02d %02d:%02d:%02d.%03d %s ",
+			1+d(re)%12, 1+d(re)%28, d(re)%24, d(re)%60, d(re)%60, d(re), levels[level_dist(re)]);
+		for (int i=0; i<n; ++i) {
+			*out = static_cast<std::uint8_t>(buf[i]);
+			++out;
+		}
+	}
+
+	const int n_words = n_words_dist(re);
+	for (int w=0; w<n_words; ++w) {
+		if (w > 0 && m.word_sep != 0) {
+			out = to_utf8(m.word_sep, out);
+		}
+		const int n_cp = word_len_dist(re);
+		for (int i=0; i<n_cp; ++i) {
+			const codepoint_range& r = m.letters[range_dist(re)];
+			std::uniform_int_distribution<std::uint32_t> cp_dist(r.first, r.last);
+			std::uint32_t cp = cp_dist(re);
+			expect(is_valid_cp(cp));
+			out = to_utf8(cp, out);
+		}
+		if (punct_dist(re)) {
+			std::uniform_int_distribution<std::size_t> punct_idx(0, m.punct.size()-1);
+			out = to_utf8(m.punct[punct_idx(re)], out);
+		}
+	}
+	*out = std::uint8_t {0x0Au};
+	++out;
+	return out;
+}
@@ -3,27 +3,61 @@
 #include <cstdint>
 #include <type_traits>
 #include <concepts>
+#include <span>
+#include <bit>
 
 
-// Clang turns this in to a single bswap; GCC and MSVC don't.  C++23 has std::byteswap.
+#if !defined(__cpp_lib_byteswap) && defined(_MSC_VER) && !defined(__clang__)
+#include <stdlib.h>  // _byteswap_*
+#endif
+
+
+// std::byteswap where available (C++23); otherwise the compiler's builtin, which is a single bswap (or
+// movbe when the operand comes from or goes to memory and the target has it).  MSVC's _byteswap_* are
+// not constexpr, so constant evaluation there (and compilers w/ neither) takes the shift-and-or loop.
 template<std::integral T>
-constexpr T reverse_bytes(const T val) {
-	if constexpr (sizeof(T) == 0) {
+constexpr T reverse_bytes(const T val) noexcept {
+#if defined(__cpp_lib_byteswap)
+	return std::byteswap(val);
+#else
+	using U = std::make_unsigned_t<T>;
+	const U u = static_cast<U>(val);
+	if constexpr (sizeof(T) == 1) {
 		return val;
 	}
-
-	T result;
-	std::byte* dest = reinterpret_cast<std::byte*>(&result) + sizeof(T);
-	--dest;
-	const std::byte* p = reinterpret_cast<const std::byte*>(&val);
-	const std::byte* p_end = reinterpret_cast<const std::byte*>(&val) + sizeof(T);
-	while (p != p_end) {
-		*dest = *p;
-		++p;
-		--dest;
+#if defined(__GNUC__) || defined(__clang__)
+	if constexpr (sizeof(T) == 2) {
+		return static_cast<T>(__builtin_bswap16(u));
+	} else if constexpr (sizeof(T) == 4) {
+		return static_cast<T>(__builtin_bswap32(u));
+	} else if constexpr (sizeof(T) == 8) {
+		return static_cast<T>(__builtin_bswap64(u));
+	}
+#elif defined(_MSC_VER)
+	if (!std::is_constant_evaluated()) {
+		if constexpr (sizeof(T) == 2) {
+			return static_cast<T>(_byteswap_ushort(u));
+		} else if constexpr (sizeof(T) == 4) {
+			return static_cast<T>(_byteswap_ulong(u));
+		} else if constexpr (sizeof(T) == 8) {
+			return static_cast<T>(_byteswap_uint64(u));
+		}
+	}
+#endif
+	U result {0};
+	for (std::size_t i=0; i<sizeof(T); ++i) {
+		result = static_cast<U>((result << 8) | ((u >> (8*i)) & 0xFFu));
 	}
-	return result;
+	return static_cast<T>(result);
+#endif
 }
 
 
+// Bulk byte-order conversion.  Each code unit of src is byte-swapped into the corresponding element of
+// dest; dest.size() must be >= src.size().  src and dest may be the same range (the single-argument
+// overloads swap in place) but must not otherwise overlap.  Vectorized where the target supports it.
+void byteswap_utf16(std::span<const std::uint16_t> src, std::span<std::uint16_t> dest);
+void byteswap_utf16(std::span<std::uint16_t> s);
+void byteswap_utf32(std::span<const std::uint32_t> src, std::span<std::uint32_t> dest);
+void byteswap_utf32(std::span<std::uint32_t> s);
 
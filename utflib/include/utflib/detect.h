@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <array>
+
+// Guessing the encoding of a byte sequence of unknown origin, for when the only alternative is to
+// try a full decode in each encoding.  See also the note in iterators.h on telling le from be by
+// running both iterators.
+
+enum class utf_encoding {utf8, utf16le, utf16be, utf32le, utf32be};
+
+struct encoding_guess {
+	utf_encoding encoding;
+	// On [0,1].  1 means the examined prefix is well-formed in this encoding and contains nothing that
+	// makes the encoding implausible (0x00 code units, utf-16 words w/ a zero low-order byte, ...).
+	// Real text can score a little under 1 (ex, U+1F600 has a zero low-order byte).
+	// This is a ranking, not a probability.
+	double score;
+};
+
+struct detected_encoding {
+	// Best guess first.  Guesses w/ equal scores are in the order of the enumerators of utf_encoding.
+	std::array<encoding_guess,5> ranked;
+	// Size in bytes of the byte order mark, or 0 if there is none.  A BOM always wins:  if there is
+	// one, ranked[0] is the encoding it implies and has score 1; the others are ranked on what
+	// follows the BOM.
+	std::size_t bom_size;
+
+	utf_encoding best() const noexcept { return ranked[0].encoding; }
+};
+
+// Checks for a BOM, then looks at no more than the first max_prefix bytes of s:  the validity of the
+// prefix in each encoding (including the pairing of utf-16 surrogates) and where the 0x00 bytes fall.
+// A code unit sequence cut off by the end of the prefix is not counted as an error; one cut off by the
+// end of s is.
+// Utf-8 w/o any 0x00 bytes is usually also valid utf-16, so the utf-16 guesses often tie w/ it; ties go
+// to utf-8.  Utf-16 w/o any ascii or latin-1 codepoints or surrogate pairs (ex, cjk text w/o spaces or newlines)
+// gives no way to tell le from be; le is ranked first.
+detected_encoding detect_encoding(std::span<const std::uint8_t> s, std::size_t max_prefix = 4096);
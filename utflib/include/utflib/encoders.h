@@ -1,6 +1,8 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <cstring>
+#include <bit>
 #include "low_level.h"
 #include "utflib.h"
 
@@ -22,17 +24,17 @@
 class utf8_generator {
 public:
 	utf8_generator()=delete;
-	utf8_generator(codepoint) noexcept;
+	constexpr utf8_generator(codepoint) noexcept;
 
-	bool is_finished() const noexcept;
-	std::uint8_t get() const noexcept;
-	bool go_next() noexcept;
-	void reset() noexcept;
+	constexpr bool is_finished() const noexcept;
+	constexpr std::uint8_t get() const noexcept;
+	constexpr bool go_next() noexcept;
+	constexpr void reset() noexcept;
 
 	// Unrolls the loop that the user would normally have to write
 	// TODO:  Constrain
 	template<typename OIt>
-	OIt get_all(OIt out) const {
+	constexpr OIt get_all(OIt out) const {
 		if (m_sz == 1) {
 			*out++ = m_u8[0];
 		} else if (m_sz == 2) {
@@ -52,14 +54,71 @@ public:
 	}
 
 private:
-	std::array<std::uint8_t,4> m_u8;
-	std::int16_t m_sz;
-	std::int16_t m_curr_idx;
+	std::array<std::uint8_t,4> m_u8 {};
+	std::int16_t m_sz {};
+	std::int16_t m_curr_idx {};
 };
 
+constexpr utf8_generator::utf8_generator(codepoint cp) noexcept {
+	std::uint32_t val = cp.get();
+	m_curr_idx = 0;
+	m_sz = size_utf8_multibyte_seq_from_codepoint(val);
+
+	// Table 3-6. UTF-8 Bit Distribution
+	// Scalar Value                 First Byte    Second Byte    Third Byte    Fourth Byte
+	// 00000000 0xxxxxxx            0xxxxxxx
+	// 00000yyy yyxxxxxx            110yyyyy      10xxxxxx
+	// zzzzyyyy yyxxxxxx            1110zzzz      10yyyyyy       10xxxxxx
+	// 000uuuuu zzzzyyyy yyxxxxxx   11110uuu      10uuzzzz       10yyyyyy      10xxxxxx
+	if (m_sz == 1) {
+		m_u8[0] = static_cast<std::uint8_t>(val);
+		m_u8[1] = 0xFFu;
+		m_u8[2] = 0xFFu;
+		m_u8[3] = 0xFFu;
+	} else if (m_sz == 2) {
+		// 00000yyy yyxxxxxx            110yyyyy      10xxxxxx
+		m_u8[0] = static_cast<std::uint8_t>(0b1100'0000u | (0b0001'1111u & (val>>6)));
+		m_u8[1] = static_cast<std::uint8_t>(0b1000'0000u | (0b0011'1111u & val));
+		m_u8[2] = 0xFFu;
+		m_u8[3] = 0xFFu;
+	} else if (m_sz == 3) {
+		// zzzzyyyy yyxxxxxx            1110zzzz      10yyyyyy       10xxxxxx
+		m_u8[0] = static_cast<std::uint8_t>(0b1110'0000u | (0b0000'1111u & (val>>12)));
+		m_u8[1] = static_cast<std::uint8_t>(0b1000'0000u | (0b0011'1111u & (val>>6)));
+		m_u8[2] = static_cast<std::uint8_t>(0b1000'0000u | (0b1011'1111u & val));
+		m_u8[3] = 0xFFu;
+	} else { // if (m_sz == 4) {
+		// 000uuuuu zzzzyyyy yyxxxxxx   11110uuu      10uuzzzz       10yyyyyy      10xxxxxx
+		m_u8[0] = static_cast<std::uint8_t>(0b1111'0000u | (0b0000'0111u & (val>>18)));  // uuu
+		m_u8[1] = static_cast<std::uint8_t>(0b1000'0000u | (0b0011'1111u & (val>>12)));  // uu'zzzz
+		m_u8[2] = static_cast<std::uint8_t>(0b1000'0000u | (0b0011'1111u & (val>>6)));
+		m_u8[3] = static_cast<std::uint8_t>(0b1000'0000u | (0b0011'1111u & val));
+	}
+}
+
+constexpr bool utf8_generator::is_finished() const noexcept {
+	return m_curr_idx==m_sz;
+}
+
+constexpr std::uint8_t utf8_generator::get() const noexcept {
+	return m_u8[m_curr_idx];
+}
+
+constexpr bool utf8_generator::go_next() noexcept {
+	if (m_curr_idx==m_sz) {
+		return false;
+	}
+	++m_curr_idx;
+	return true;
+}
+
+constexpr void utf8_generator::reset() noexcept {
+	m_curr_idx = 0;
+}
+
 
 template<typename OIt>
-OIt to_utf8(std::uint32_t cp, OIt out) {
+constexpr OIt to_utf8(std::uint32_t cp, OIt out) {
 	std::optional<codepoint> ocp = codepoint::to_codepoint(cp);
 	if (!ocp) {
 		return out;
@@ -69,22 +128,30 @@ OIt to_utf8(std::uint32_t cp, OIt out) {
 	return out;
 }
 
+// As to_utf8, but cp is not checked; undefined if cp is not a valid codepoint.  For input validated
+// upstream.
+template<typename OIt>
+constexpr OIt to_utf8_unchecked(std::uint32_t cp, OIt out) {
+	utf8_generator g(codepoint::to_codepoint_unchecked(cp));
+	return g.get_all(out);
+}
+
 
 // For a given codepoint, generates in order the bytes in the utf16 representation
 class utf16_generator {
 public:
 	utf16_generator()=delete;
-	utf16_generator(codepoint) noexcept;
+	constexpr utf16_generator(codepoint) noexcept;
 
-	bool is_finished() const noexcept;
-	std::uint16_t get() const noexcept;
-	bool go_next() noexcept;
-	void reset() noexcept;
+	constexpr bool is_finished() const noexcept;
+	constexpr std::uint16_t get() const noexcept;
+	constexpr bool go_next() noexcept;
+	constexpr void reset() noexcept;
 
 	// Unrolls the loop that the user would normally have to write
 	// TODO:  Constrain
 	template<typename OIt>
-	OIt get_all(OIt out) const {
+	constexpr OIt get_all(OIt out) const {
 		if (m_sz == 1) {
 			*out++ = m_u16[0];
 		} else { // if (m_sz == 2)
@@ -95,15 +162,55 @@ public:
 	}
 
 private:
-	std::array<std::uint16_t,2> m_u16;
-	std::int16_t m_sz;
-	std::int16_t m_curr_idx;
+	std::array<std::uint16_t,2> m_u16 {};
+	std::int16_t m_sz {};
+	std::int16_t m_curr_idx {};
 };
 
+constexpr utf16_generator::utf16_generator(codepoint cp) noexcept {
+	std::uint32_t val = cp.get();
+	m_curr_idx = 0;
+	m_sz = size_utf16_code_unit_seq_from_codepoint(val);
+
+	// #Table 3-5. UTF-16 Bit Distribution
+	// Scalar Value                UTF-16
+	// xxxxxxxxxxxxxxxx            xxxxxxxxxxxxxxxx
+	// 000uuuuuxxxxxxxxxxxxxxxx    110110wwwwxxxxxx 110111xxxxxxxxxx
+	if (m_sz == 1) {
+		m_u16[0] = static_cast<std::uint16_t>(val);
+	} else if (m_sz == 2) {
+		std::uint16_t wwww = (val>>16)-1;
+		std::uint16_t xxxxxx = (val>>10)&0b111111u;
+		m_u16[0] = static_cast<std::uint16_t>((0b110110u<<10) | (wwww<<6) | xxxxxx);
+		std::uint16_t xxxxxxxxxx = val&0b1111111111u;
+		m_u16[1] = static_cast<std::uint16_t>((0b110111u<<10) | xxxxxxxxxx);
+	}
+}
+
+constexpr bool utf16_generator::is_finished() const noexcept {
+	return m_curr_idx==m_sz;
+}
+
+constexpr std::uint16_t utf16_generator::get() const noexcept {
+	return m_u16[m_curr_idx];
+}
+
+constexpr bool utf16_generator::go_next() noexcept {
+	if (m_curr_idx==m_sz) {
+		return false;
+	}
+	++m_curr_idx;
+	return true;
+}
+
+constexpr void utf16_generator::reset() noexcept {
+	m_curr_idx = 0;
+}
+
 
 // Undefined if cp is not a valid codepoint
 template<typename OIt>
-OIt to_utf16(std::uint32_t cp, OIt out) {
+constexpr OIt to_utf16(std::uint32_t cp, OIt out) {
 	std::optional<codepoint> ocp = codepoint::to_codepoint(cp);
 	if (!ocp) {
 		return out;
@@ -113,4 +220,86 @@ OIt to_utf16(std::uint32_t cp, OIt out) {
 	return out;
 }
 
+// As to_utf16, but cp is not checked; undefined if cp is not a valid codepoint.  For input validated
+// upstream.
+template<typename OIt>
+constexpr OIt to_utf16_unchecked(std::uint32_t cp, OIt out) {
+	utf16_generator g(codepoint::to_codepoint_unchecked(cp));
+	return g.get_all(out);
+}
+
+
+//
+// Direct-to-pointer encoding
+//
+// For writing into a buffer the caller has already sized.  An output iterator like back_inserter has to
+// check capacity for every code unit; these write the whole sequence w/ a single unaligned 4-byte store.
+// The store always writes 4 bytes, so there must be room for 4 bytes at dst even when the encoding is
+// shorter; the bytes past the returned pointer are junk and are overwritten by the next call.  Size the
+// buffer w/ 3 bytes (1 word for utf-16) of slack past the end of the data, or use the overloads that
+// take an end pointer.
+
+// Returns one past the last byte of the encoding
+inline std::uint8_t* encode_utf8(codepoint cp, std::uint8_t* dst) noexcept {
+	// Branch-free, since the length of the encoding is unpredictable in mixed text.  The payload is laid
+	// out as for a 4-byte sequence (Table 3-6), in memory order w/ the first byte in the low-order bits,
+	// then the unused leading bytes are shifted out and the marker bits for the actual length or'ed in.
+	// Single bytes have 7 payload bits rather than 6 and are selected w/ a mask (a ternary gets compiled
+	// to a branch).
+	static constexpr std::uint32_t markers[5] {0, 0, 0x0000'80C0u, 0x0080'80E0u, 0x8080'80F0u};
+	const std::uint32_t v = cp.get();
+	const int sz = 1 + (v > 0x7Fu) + (v > 0x7FFu) + (v > 0xFFFFu);
+	const std::uint32_t payload = (v>>18) | (((v>>12) & 0x3Fu)<<8) | (((v>>6) & 0x3Fu)<<16) | ((v & 0x3Fu)<<24);
+	const std::uint32_t multi = (payload >> (8*(4-sz))) | markers[sz];
+	const std::uint32_t ascii_mask = 0u - static_cast<std::uint32_t>(sz == 1);
+	std::uint32_t b = (v & ascii_mask) | (multi & ~ascii_mask);
+	if constexpr (std::endian::native == std::endian::big) {
+		b = reverse_bytes(b);
+	}
+	std::memcpy(dst, &b, sizeof(b));
+	return dst + sz;
+}
 
+// As above, but never writes at or past dst_end.  Within 4 bytes of dst_end the bytes are written one
+// at a time.  Returns dst (nothing written) if the encoding does not fit.
+inline std::uint8_t* encode_utf8(codepoint cp, std::uint8_t* dst, std::uint8_t* dst_end) noexcept {
+	if (dst_end-dst >= 4) [[likely]] {
+		return encode_utf8(cp, dst);
+	}
+	if (dst_end-dst < size_utf8_multibyte_seq_from_codepoint(cp.get())) {
+		return dst;
+	}
+	return utf8_generator(cp).get_all(dst);
+}
+
+// Returns one past the last word of the encoding.  There must be room for 2 words at dst.
+inline std::uint16_t* encode_utf16(codepoint cp, std::uint16_t* dst) noexcept {
+	const std::uint32_t v = cp.get();
+	// w holds the words in memory order, the first in the low-order bits
+	std::uint32_t w {};
+	int sz {};
+	if (v <= 0xFFFFu) {
+		w = v;
+		sz = 1;
+	} else {
+		w = (0xD800u | ((v-0x10000u)>>10)) | ((0xDC00u | (v & 0x3FFu))<<16);
+		sz = 2;
+	}
+	if constexpr (std::endian::native == std::endian::big) {
+		w = (w<<16) | (w>>16);
+	}
+	std::memcpy(dst, &w, sizeof(w));
+	return dst + sz;
+}
+
+// As above, but never writes at or past dst_end.  Returns dst (nothing written) if the encoding does not
+// fit.
+inline std::uint16_t* encode_utf16(codepoint cp, std::uint16_t* dst, std::uint16_t* dst_end) noexcept {
+	if (dst_end-dst >= 2) [[likely]] {
+		return encode_utf16(cp, dst);
+	}
+	if (dst_end-dst < size_utf16_code_unit_seq_from_codepoint(cp.get())) {
+		return dst;
+	}
+	return utf16_generator(cp).get_all(dst);
+}
@@ -14,12 +14,14 @@
 struct utf8_customizer {
 	using underlying = std::uint8_t;
 	using codepoint_type = utf8_codepoint;
+	using packed_type = packed_utf8_char;
 	static std::optional<int> pred(std::span<const underlying>);
 };
 
 struct utf16_customizer {
 	using underlying = std::uint16_t;
 	using codepoint_type = utf16_codepoint;
+	using packed_type = packed_utf16_char;
 	static std::optional<int> pred(std::span<const underlying>);
 };
 
@@ -61,7 +63,7 @@ public:
 		}
 
 		// On the start of an invalid subsequence
-		const custom::underlying* p = m_p;
+		const typename custom::underlying* p = m_p;
 		while (true) {
 			++p;
 			if (p == m_pend) {
@@ -83,7 +85,7 @@ public:
 			return false;
 		}
 
-		const custom::underlying* p = m_p;
+		const typename custom::underlying* p = m_p;
 		std::optional<int> sz = std::nullopt;
 		while (true) {
 			--p;
@@ -115,19 +117,30 @@ public:
 	std::optional<codepoint> get_codepoint() const {
 		std::optional<int> sz = custom::pred({m_p,m_pend});
 		if (sz) {
-			return codepoint(std::span<const custom::underlying>{m_p,m_p+*sz});
+			return codepoint(std::span<const typename custom::underlying>{m_p,m_p+*sz});
 		}
 		return std::nullopt;
 	}
 	
 	std::optional<typename custom::codepoint_type> get() const {
-		std::optional<int> sz = custom::pred(std::span<const custom::underlying>{m_p,m_pend});
+		std::optional<int> sz = custom::pred(std::span<const typename custom::underlying>{m_p,m_pend});
 		if (sz) {
-			return custom::codepoint_type(std::span<const custom::underlying>{m_p,m_p+*sz});
+			return typename custom::codepoint_type(std::span<const typename custom::underlying>{m_p,m_p+*sz});
 		}
 		return std::nullopt;
 	}
 	
+	// As get(), but a copy of the code units that does not refer back to the source (utf-8 & utf-16 only)
+	// (auto so that the return type is not formed for utf32_customizer, which has no packed_type)
+	auto get_packed() const requires requires { typename custom::packed_type; } {
+		using packed = typename custom::packed_type;
+		std::optional<int> sz = custom::pred(std::span<const typename custom::underlying>{m_p,m_pend});
+		if (sz) {
+			return std::optional<packed>(packed(std::span<const typename custom::underlying>{m_p,m_p+*sz}));
+		}
+		return std::optional<packed>();
+	}
+	
 	// This is the only get()ter the iterator "should" expose but since it has to compute the valid
 	// code unit subsequence anyway it is effecient for it to also offer get().
 	std::span<const typename custom::underlying> get_underlying() const {
@@ -139,7 +152,7 @@ public:
 			return {m_p,m_p+*sz};
 		}
 
-		const custom::underlying* p = m_p;
+		const typename custom::underlying* p = m_p;
 		while (true) {
 			++p;
 			if (p==m_pend) {
@@ -187,9 +200,9 @@ public:
 		return m_pbeg==lhs.m_pbeg && m_p==lhs.m_p && m_pend==lhs.m_pend;
 	}
 private:
-	const custom::underlying* m_p {};
-	const custom::underlying* m_pbeg {};
-	const custom::underlying* m_pend {};
+	const typename custom::underlying* m_p {};
+	const typename custom::underlying* m_pbeg {};
+	const typename custom::underlying* m_pend {};
 };
 
 
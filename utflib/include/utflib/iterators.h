@@ -53,6 +53,7 @@ public:
 
 	std::optional<codepoint> get_codepoint() const;
 	std::optional<utf8_codepoint> get() const;
+	std::optional<packed_utf8_char> get_packed() const;  // As get(), but does not refer back to the source
 	
 	// This is the only get()ter the iterator "should" expose but since it has to compute the valid
 	// code unit subsequence anyway it is effecient for it to also offer get().
@@ -78,6 +79,7 @@ public:
 
 	std::optional<codepoint> get_codepoint() const;
 	std::optional<utf16_codepoint> get() const;
+	std::optional<packed_utf16_char> get_packed() const;  // As get(), but does not refer back to the source
 	
 	// This is the only get()ter the iterator "should" expose but since it has to compute the valid
 	// code unit subsequence anyway it is effecient for it to also offer get().
@@ -89,6 +91,58 @@ private:
 };
 
 
+// For utf-16 in the byte order opposite that of the host.  Treats all ill-formed subsequences, no
+// matter how long, and no matter their contents, as single errors
+class utf16_iterator_swapping {
+public:
+	utf16_iterator_swapping()=delete;
+	explicit utf16_iterator_swapping(std::span<const std::uint16_t>);
+
+	bool is_finished() const;
+	bool at_start() const;
+
+	bool go_next();  // false if it didn't go anywhere (=>is_finished() prior to the call)
+	bool go_prev();  // false if it didn't go anywhere (=>at_start() prior to the call)
+
+	std::optional<codepoint> get_codepoint() const;
+	std::optional<utf16_codepoint_swapped> get() const;
+	
+	// This is the only get()ter the iterator "should" expose but since it has to compute the valid
+	// code unit subsequence anyway it is efficient for it to also offer get().
+	std::span<const std::uint16_t> get_underlying() const;
+private:
+	const std::uint16_t* m_p {};
+	const std::uint16_t* m_pbeg {};
+	const std::uint16_t* m_pend {};
+};
+
+
+// For utf-16 in the byte order opposite that of the host.  Every word not part of a valid code unit
+// sequence is treated as an indivdual error
+class utf16_iterator_alt_swapping {
+public:
+	utf16_iterator_alt_swapping()=delete;
+	explicit utf16_iterator_alt_swapping(std::span<const std::uint16_t>);
+
+	bool is_finished() const;
+	bool at_start() const;
+
+	bool go_next();  // false if it didn't go anywhere (=>is_finished() prior to the call)
+	bool go_prev();  // false if it didn't go anywhere (=>at_start() prior to the call)
+
+	std::optional<codepoint> get_codepoint() const;
+	std::optional<utf16_codepoint_swapped> get() const;
+	
+	// This is the only get()ter the iterator "should" expose but since it has to compute the valid
+	// code unit subsequence anyway it is efficient for it to also offer get().
+	std::span<const std::uint16_t> get_underlying() const;
+private:
+	const std::uint16_t* m_p {};
+	const std::uint16_t* m_pbeg {};
+	const std::uint16_t* m_pend {};
+};
+
+
 // Treats all ill-formed subsequences, no matter how long, and no matter their contents, as single errors
 class utf32_iterator_swapping {
 public:
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// A line is the byte range [offset, offset of the next line) and includes its terminating 0x0A
+// (\n), if any.  A 0x0A can never appear inside a well-formed multibyte sequence, so splitting on
+// 0x0A never splits a valid codepoint.
+struct utf8_line {
+	std::size_t offset {};  // Offset of the first byte of the line from the start of the buffer
+	std::size_t n_cp {};    // Number of well-formed codepoints on the line, not counting the 0x0A
+	bool is_valid {};       // False if the line contains at least one ill-formed subsequence
+};
+
+// Splits s on 0x0A and, in the same pass, counts the codepoints on each line and checks that each
+// line is well-formed utf-8.  Runs of ascii are processed 16 bytes at a time; only the bytes of
+// multibyte (or ill-formed) sequences are examined individually.
+// An empty span has no lines.  A trailing 0x0A terminates the last line; it does not begin a new,
+// empty one.
+std::vector<utf8_line> index_utf8_lines(std::span<const std::uint8_t> s);
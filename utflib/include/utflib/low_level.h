@@ -1,7 +1,9 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include <span>
 #include <optional>
+#include "byte_manip.h"
 
 // Table 3-7. Well-Formed UTF-8 Byte Sequences
 // Code Points          First Byte    Second Byte    Third Byte    Fourth Byte
@@ -18,42 +20,95 @@
 
 // True if b falls in the range given in any row of the "First Byte" column of table 3-7, false
 // otherwise.
-bool is_valid_utf8_leading_byte(std::uint8_t b);
+constexpr bool is_valid_utf8_leading_byte(std::uint8_t b) {
+	return (b<=0x7F || (b>=0xC2 && b<=0xF4));
+}
 
 // True if tb falls in the range given in the "Second Byte" column for the row corresponding to the
 // First Byte lb, false otherwise.  If lb is outside the range of any of the rows of the First Byte
 // column of table 3-7 (that is, if lb is not a valid leading byte), the result is undefined; do not
 // call this function with a value of tb for which is_valid_utf8_leading_byte returns false.
-bool is_valid_utf8_second_byte(std::uint8_t tb, std::uint8_t lb);
-
-// True if lb falls on [0x80, 0xBF], false otherwise.
-bool is_valid_utf8_third_or_fourth_byte(std::uint8_t lb);
+constexpr bool is_valid_utf8_second_byte(std::uint8_t tb, std::uint8_t lb) {
+	if (lb <= 0x7F) {
+		return false;  // There is no second byte
+	} else if (lb >= 0xC2 && lb <= 0xDF) {
+		return tb >= 0x80 && tb <= 0xBF;
+	} else if (lb == 0xE0) {
+		return tb >= 0xA0 && tb <= 0xBF;
+	} else if (lb >= 0xE1 && lb <= 0xEC) {
+		return tb >= 0x80 && tb <= 0xBF;
+	} else if (lb == 0xED) {
+		return tb >= 0x80 && tb <= 0x9F;
+	} else if (lb >= 0xEE && lb <= 0xEF) {
+		return tb >= 0x80 && tb <= 0xBF;
+	} else if (lb == 0xF0) {
+		return tb >= 0x90 && tb <= 0xBF;
+	} else if (lb >= 0xF1 && lb <= 0xF3) {
+		return tb >= 0x80 && tb <= 0xBF;
+	} else { // (lb == 0xF4)
+		return tb >= 0x80 && tb <= 0x8F;
+	}
+}
+
+// True if tb falls on [0x80, 0xBF], false otherwise.
+constexpr bool is_valid_utf8_third_or_fourth_byte(std::uint8_t tb) {
+	return tb >= 0x80 && tb <= 0xBF;
+}
 
 // True if b is on [0x80, 0xBF], false otherwise.  A byte in this range *might* be a valid
 // trailing byte, but a byte outside this range can *never* be a valid trailing byte.  Although
 // all third and fourth trailing bytes fall on [0x80, 0xBF], for certain code unit sequences,
 // the second trailing byte is restricted to fall on [0xA0, 0xBF], [0x80, 0x9F], [0x90, 0xBF],
 // or [0x80, 0x8F] depending on the leading byte; see Table 3-7.
-bool is_utf8_trailing_byte(std::uint8_t b);
+constexpr bool is_utf8_trailing_byte(std::uint8_t b) {
+	return (b>=0x80 && b<=0xBF);
+}
 
 // From the first byte b of a multibyte sequence, computes the number of bytes in the sequence.
 // If b is not a valid leading byte of a multibyte sequence the result is undefined.  Do not 
 // call this function with a value of b for which is_valid_utf8_leading_byte returns false.
-int size_utf8_multibyte_seq_from_leading_byte(std::uint8_t b);
+constexpr int size_utf8_multibyte_seq_from_leading_byte(std::uint8_t b) {
+	if ((b & 0b10000000) == 0) {
+		return 1;
+	} else if ((b & 0b11100000) == 0b11000000) {
+		return 2;
+	} else if ((b & 0b11110000) == 0b11100000) {
+		return 3;
+	} else {
+		return 4;
+	}
+}
 
 // Returns the number of bytes required to encode the given codepoint cp as a utf8 byte sequence.
 // The result is undefined if cp is not a valid codepoint.  Do not call this function with a value of
 // cp for which is_valid_cp returns false.
-int size_utf8_multibyte_seq_from_codepoint(std::uint32_t cp);
+constexpr int size_utf8_multibyte_seq_from_codepoint(std::uint32_t cp) {
+	if (cp <= 0x7Fu) { return 1; }
+	if (cp <= 0x7FFu) { return 2; }
+	if (cp <= 0xFFFFu) { return 3; }
+	return 4;
+}
 
 // Extracts the value bits from the leading byte of a potentially multibyte sequence.
 // sz_multib == size_utf8_multibyte_seq_from_leading_byte(b); the result is undefined if sz_multib is incorrect
 // or if b is not a valid leading byte (ie, if !is_valid_utf8_leading_byte(b)).
-std::uint8_t payload_utf8_leading_byte(std::uint8_t b, int sz_multib);
+constexpr std::uint8_t payload_utf8_leading_byte(std::uint8_t b, int sz_multib) {
+	if (sz_multib == 1) {
+		return 0x7Fu & b;
+	} else if (sz_multib == 2) {
+		return 0x1Fu & b;
+	} else if (sz_multib == 3) {
+		return 0x0Fu & b;
+	} else { // (sz_multib == 4) 
+		return 0x07u & b;
+	}
+}
 
 // Extracts the value bits from a trailing byte of a multibyte sequence.  The result
 // is undefined if !is_valid_trailing_byte(b).
-std::uint8_t payload_utf8_trailing_byte(std::uint8_t b);
+constexpr std::uint8_t payload_utf8_trailing_byte(std::uint8_t b) {
+	return 0x3Fu & b;
+}
 
 struct leading_byte_ptr_with_size {
 	const std::uint8_t* p {};
@@ -71,17 +126,123 @@ leading_byte_ptr_with_size seek_to_first_utf8_leading_byte(std::span<const std::
 std::span<const std::uint8_t> seek_to_first_valid_utf8_sequence(std::span<const std::uint8_t> s);
 
 // TODO:  Unit tests
-std::optional<int> begins_with_valid_utf8(std::span<const std::uint8_t> s);
+// TODO:  This still discards information (about which byte was bad)
+constexpr std::optional<int> begins_with_valid_utf8(std::span<const std::uint8_t> s) {
+	if (s.size() == 0) {
+		return std::nullopt;
+	}
+	if (!is_valid_utf8_leading_byte(s[0])) {
+		return std::nullopt;
+	}
+	int sz = size_utf8_multibyte_seq_from_leading_byte(s[0]);
+	if(s.size() < static_cast<std::size_t>(sz)) {
+		return std::nullopt;
+	}
+	if (sz == 1) {
+		return sz;
+	}
+	if (!is_valid_utf8_second_byte(s[1],s[0])) {
+		return std::nullopt;
+	}
+	if (sz == 2) {
+		return sz;
+	}
+	if (!is_valid_utf8_third_or_fourth_byte(s[2])) {
+		return std::nullopt;
+	}
+	if (sz == 3) {
+		return sz;
+	}
+	if (!is_valid_utf8_third_or_fourth_byte(s[3])) {
+		return std::nullopt;
+	}
+	return sz;
+}
 // The span must contain exactly one codepoint and s.size()==size_utf8_multibyte_seq_from_leading_byte(s[0])
-bool is_valid_utf8_single_codepoint(std::span<const std::uint8_t> s);
+constexpr bool is_valid_utf8_single_codepoint(std::span<const std::uint8_t> s) {
+	if (s.size() == 0) {
+		return false;
+	}
+	if (!is_valid_utf8_leading_byte(s[0])) {
+		return false;
+	}
+	int sz = size_utf8_multibyte_seq_from_leading_byte(s[0]);
+	if (s.size() != static_cast<std::size_t>(sz)) {
+		return false;
+	}
+	if (sz == 1) {
+		return true;
+	}
+	if (!is_valid_utf8_second_byte(s[1],s[0])) {
+		return false;
+	}
+	if (sz == 2) {
+		return true;
+	}
+	if (!is_valid_utf8_third_or_fourth_byte(s[2])) {
+		return false;
+	}
+	if (sz == 3) {
+		return true;
+	}
+	if (!is_valid_utf8_third_or_fourth_byte(s[3])) {
+		return false;
+	}
+	return true;
+}
+
+// Table-driven alternatives to begins_with_valid_utf8 and begins_with_valid_utf8 followed by to_utf32.
+// A DFA in the style of Bjoern Hoehrmann's decoder (http://bjoern.hoehrmann.de/utf-8/decoder/dfa/)
+// with one table lookup per byte:  a byte is mapped to one of 12 classes, and (state, class) to the next
+// state.  The only branches are the loop exits, so unlike the if-else cascade above the cost does not
+// depend on how predictable the sequence lengths are.  Same results as begins_with_valid_utf8.  The
+// whole-buffer routines (validate_utf8, index_utf8_lines, ...) run the same machine for their scalar
+// paths.
+std::optional<int> begins_with_valid_utf8_dfa(std::span<const std::uint8_t> s);
+struct utf8_decoded {
+	std::uint32_t cp {};
+	int sz {};
+};
+std::optional<utf8_decoded> decode_utf8_dfa(std::span<const std::uint8_t> s);
 
 
-bool is_valid_cp(std::uint32_t cp);
+constexpr bool is_valid_cp(std::uint32_t cp) {
+	return (cp <= 0xD7FFu)
+		|| (cp>=0xE000u && cp<=0x10FFFFu);
+}
 
 // Undefined if s is not a valid utf8 byte sequence
 // Assumes that s.size() > 0 && s.size() >= size_utf8_multibyte_seq_from_leading_byte(s[0])
 // TODO:  Rename to to_codepoint?  to_unicode_scalar_value()?
-std::uint32_t to_utf32(std::span<const std::uint8_t> s);
+constexpr std::uint32_t to_utf32(std::span<const std::uint8_t> s) {
+	const std::uint8_t* p = s.data();
+	int sz = size_utf8_multibyte_seq_from_leading_byte(*p);
+	std::uint32_t result {};
+	result += payload_utf8_leading_byte(*p,sz);
+	if (sz == 1) { return result; }
+	result <<= 6;
+	++p;
+	result += payload_utf8_trailing_byte(*p);
+	if (sz == 2) { return result; }
+	result <<= 6;
+	++p;
+	result += payload_utf8_trailing_byte(*p);
+	if (sz == 3) { return result; }
+	result <<= 6;
+	++p;
+	result += payload_utf8_trailing_byte(*p);
+	return result;
+}
+
+// Returns the longest prefix of s that is no longer than max_bytes and does not end in the middle of a
+// multibyte sequence.  Only s[max_bytes] and at most the three bytes before it are examined; nothing
+// else in s is read, so the cost does not depend on s.size() or max_bytes.  If s[max_bytes] is preceded
+// by more than three trailing bytes the data is ill-formed there and s is cut at max_bytes.
+std::span<const std::uint8_t> truncate_utf8(std::span<const std::uint8_t> s, std::size_t max_bytes);
+
+// As truncate_utf8, but also validates the last codepoint of the result.  Returns std::nullopt if it is
+// ill-formed.  Nothing before the last codepoint is validated.
+std::optional<std::span<const std::uint8_t>> truncate_utf8_validate_tail(std::span<const std::uint8_t> s, std::size_t max_bytes);
 
 
 //
@@ -96,26 +257,67 @@ std::uint32_t to_utf32(std::span<const std::uint8_t> s);
 // Returns true if the given word is a valid codepoint; it follows that the word is not a member
 // of a surrogate pair.  False otherwise.
 // Valid codepoints not encoded in utf-16 by surrogate pairs fall on [0x0,0xD7FF] or [0xE000,0xFFFF].
-bool is_valid_utf16_codepoint(std::uint16_t w);
+constexpr bool is_valid_utf16_codepoint(std::uint16_t w) {
+	// Could delegate to is_valid_cp(std::uint32_t cp), but in the worst case that has to make
+	// three comparisons so this is possibly *slightly* more efficient, at least in the absence of
+	// inlining and LTO that may eleminate the unnecessary comparison.
+	return !(w>=0xD800u && w<=0xDFFFu);
+}
 
 // Returns true if the given word is valid as the leading word of a surrogate pair, false otherwise.
-bool is_valid_utf16_surrogate_pair_leading(std::uint16_t w);
+// is_valid_utf16_surrogate_pair_leading(w) => !is_valid_utf16_codepoint(w)
+constexpr bool is_valid_utf16_surrogate_pair_leading(std::uint16_t w) {
+	// This establishes that w falls on [0xD800, 0xDBFF], a subset of the range of invalid unicode
+	// scalar values that can be represented by a single 16 bit integer [0xD800,0xDFFF].
+	return ((w>>10) == 0b110110u);
+}
 
 // Returns true if the given word is valid as the trailing word of a surrogate pair, false otherwise.
-bool is_valid_utf16_surrogate_pair_trailing(std::uint16_t w);
-
-bool is_valid_utf16_surrogate_pair(std::uint16_t lw, std::uint16_t tw);
-
-std::uint16_t payload_leading_word_utf16_surrogate(std::uint16_t lw);
-std::uint16_t payload_trailing_word_utf16_surrogate(std::uint16_t tw);
-
-std::uint32_t utf16_to_codepoint_value(std::uint16_t w);
-std::uint32_t utf16_to_codepoint_value(std::uint16_t lw, std::uint16_t tw);
+constexpr bool is_valid_utf16_surrogate_pair_trailing(std::uint16_t w) {
+	// This establishes that w falls on [0xDC00, 0xDFFF], a subset of the range of invalid unicode
+	// scalar values that can be represented by a single 16 bit integer [0xD800,0xDFFF].
+	return ((w>>10) == 0b110111u);
+}
+
+// TODO:  Could I do this more efficiently by converting to a codepoint?
+constexpr bool is_valid_utf16_surrogate_pair(std::uint16_t lw, std::uint16_t tw) {
+	return is_valid_utf16_surrogate_pair_leading(lw) && is_valid_utf16_surrogate_pair_trailing(tw);
+}
+
+constexpr std::uint16_t payload_leading_word_utf16_surrogate(std::uint16_t lw) {
+	constexpr std::uint16_t xmask {0b0000'0000'0011'1111u};
+	constexpr std::uint16_t wmask {0b0000'0011'1100'0000u};
+	std::uint16_t wwww = ((wmask & lw)>>6);
+	std::uint16_t xxxxxx = xmask & lw;
+	std::uint16_t uuuuu = wwww + std::uint16_t {1};
+	return ((uuuuu<<6) | xxxxxx);
+}
+constexpr std::uint16_t payload_trailing_word_utf16_surrogate(std::uint16_t tw) {
+	return tw & 0b0000'0011'1111'1111u;
+}
+
+constexpr std::uint32_t utf16_to_codepoint_value(std::uint16_t w) {
+	return w;
+}
+constexpr std::uint32_t utf16_to_codepoint_value(std::uint16_t lw, std::uint16_t tw) {
+	std::uint32_t h = payload_leading_word_utf16_surrogate(lw)<<10;
+	std::uint32_t l = payload_trailing_word_utf16_surrogate(tw);
+	return h|l;
+}
 
 // Returns the number of words required to encode the given codepoint cp as a utf16 uint16_t sequence.
 // The result is undefined if cp is not a valid codepoint.  Do not call this function with a value of
 // cp for which is_valid_cp returns false.
-int size_utf16_code_unit_seq_from_codepoint(std::uint32_t);
+constexpr int size_utf16_code_unit_seq_from_codepoint(std::uint32_t cp) {
+	// UTF-16 encoding form: The Unicode encoding form that assigns each Unicode scalar value
+	// in the ranges U+0000..U+D7FF and U+E000..U+FFFF to a single unsigned 16-bit code unit with
+	// the same numeric value as the Unicode scalar value, and that assigns each Unicode scalar
+	// value in the range U+10000..U+10FFFF to a surrogate pair, according to Table 3-5.
+	if (cp>=0x10000u) {
+		return 2;
+	}
+	return 1;
+}
 
 // Gets the first valid utf16 word sequence it finds starting at s.begin().  The span encloses the
 // word sequence corresponding to the single code point.  In an alternative design it could merely
@@ -125,13 +327,64 @@ int size_utf16_code_unit_seq_from_codepoint(std::uint32_t);
 std::span<const std::uint16_t> seek_to_first_valid_utf16_sequence(std::span<const std::uint16_t> s);
 
 // TODO:  Unit tests
-std::optional<int> begins_with_valid_utf16(std::span<const std::uint16_t> s);
+constexpr std::optional<int> begins_with_valid_utf16(std::span<const std::uint16_t> s) {
+	if (s.size() == 0) {
+		return std::nullopt;
+	}
+	if (is_valid_utf16_codepoint(s[0])) {
+		return 1;
+	}
+	if (!is_valid_utf16_surrogate_pair_leading(s[0])) {
+		return std::nullopt;
+	}
+	// s[0] is a valid leading word of a surrogate pair
+	if (s.size() < 2) {
+		return std::nullopt;
+	}
+	if (is_valid_utf16_surrogate_pair_trailing(s[1])) {
+		return 2;
+	}
+	return std::nullopt;
+}
 
 // The span must contain exactly one codepoint:
 // s.size()==1 && is_valid_utf16_codepoint(s[0])
 // or
 // s.size()==2 && is_valid_utf16_surrogate_pair(s[0],s[1])
-bool is_valid_utf16_single_codepoint(std::span<const std::uint16_t> s);
+constexpr bool is_valid_utf16_single_codepoint(std::span<const std::uint16_t> s) {
+	if (s.size()==1 && is_valid_utf16_codepoint(s[0])) {
+		return true;
+	}
+	if (s.size()==2 && is_valid_utf16_surrogate_pair(s[0],s[1])) {
+		return true;
+	}
+	return false;
+}
+
+// As begins_with_valid_utf16 and seek_to_first_valid_utf16_sequence, but for utf-16 in the byte order
+// opposite that of the host:  each word is byte-swapped before it is examined.
+constexpr std::optional<int> begins_with_valid_utf16_reversed(std::span<const std::uint16_t> s) {
+	if (s.size() == 0) {
+		return std::nullopt;
+	}
+	const std::uint16_t lw = reverse_bytes(s[0]);
+	if (is_valid_utf16_codepoint(lw)) {
+		return 1;
+	}
+	if (s.size() >= 2 && is_valid_utf16_surrogate_pair(lw, reverse_bytes(s[1]))) {
+		return 2;
+	}
+	return std::nullopt;
+}
+std::span<const std::uint16_t> seek_to_first_valid_utf16_sequence_reversed(std::span<const std::uint16_t> s);
+
+// Returns the longest prefix of s that is no longer than max_words and does not split a surrogate pair.
+// Only s[max_words-1] and s[max_words] are examined.
+std::span<const std::uint16_t> truncate_utf16(std::span<const std::uint16_t> s, std::size_t max_words);
+
+// As truncate_utf16, but also validates the last codepoint of the result.  Returns std::nullopt if it is
+// an unpaired surrogate.  Nothing before the last codepoint is validated.
+std::optional<std::span<const std::uint16_t>> truncate_utf16_validate_tail(std::span<const std::uint16_t> s, std::size_t max_words);
 
 
 //
@@ -143,8 +396,14 @@ bool is_valid_utf16_single_codepoint(std::span<const std::uint16_t> s);
 // Because surrogate code points are not included in the set of Unicode scalar values,
 // UTF-32 code units in the range 0000D80016..0000DFFF16 are ill-formed.
 // TODO:  Do i really need this?  See is_valid_cp
-bool is_valid_utf32_codepoint(std::uint32_t dw);
-bool is_valid_utf32_codepoint_reversed(std::uint32_t dw);
+constexpr bool is_valid_utf32_codepoint(std::uint32_t dw) {
+	return is_valid_cp(dw);
+}
+constexpr bool is_valid_utf32_codepoint_reversed(std::uint32_t dw) {
+	//return (dw < reverse_bytes(0xD800u))
+	//	|| (dw>=reverse_bytes(0xE0'00'00u) && dw<=reverse_bytes(0x10FFFFu));
+	return is_valid_cp(reverse_bytes(dw));
+}
 
 // The size of the span is always 1 or 0 (if there is nothing valid on the input range)
 // This really only exists for consistency with the api for the other encoding forms
@@ -156,6 +415,14 @@ std::span<const std::uint32_t> seek_to_first_valid_utf32_sequence_reversed(std::
 // is all that is really needed because the return value (when not nullopt) will always be 1 and there is no
 // need to input a span since utf32 codepoints always have size 1.  One thing this *does* enable though is
 // asking about an empty range.
-std::optional<int> begins_with_valid_utf32(std::span<const std::uint32_t>);
+constexpr std::optional<int> begins_with_valid_utf32(std::span<const std::uint32_t> s) {
+	if (s.size()==0) {
+		return std::nullopt;
+	}
+	if (is_valid_utf32_codepoint(s[0])) {
+		return 1;
+	}
+	return std::nullopt;
+}
 
 void expect(bool, const char* = nullptr);
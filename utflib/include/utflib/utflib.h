@@ -5,15 +5,19 @@
 #include <vector>
 #include <concepts>
 #include <ranges>
+#include <optional>
+#include <array>
+#include <string_view>
+#include "low_level.h"
 
 
-// TODO:  Detect encoding
+// Encoding detection:  see detect.h
 
 // A non-owning view of a well-formed utf8 code unit sequence encoding exactly one codepoint
 // TODO:  Templated on the underlying datatype?  Should I allow T's other than std::uint8_t?
 // TODO:  utf8_code_unit_sequence?  utf8_encoded_codepoint?  utf8_view?
 // TODO:  Is this useful?  Since it does ! allow mutation, it takes up more space than the actual
-//        byte sequence encoding the codepoint would.
+//        byte sequence encoding the codepoint would.  See packed_utf8_char.
 class utf8_codepoint : public std::ranges::view_interface<utf8_codepoint> {
 public:
 	utf8_codepoint() = delete;
@@ -45,7 +49,7 @@ private:
 // TODO:  Templated on the underlying datatype?  Should I allow T's other than std::uint16_t?
 // TODO:  utf16_code_unit_sequence?  utf16_encoded_codepoint?  utf16_view?
 // TODO:  Is this useful?  Since it does ! allow mutation, it takes up more space than the actual
-//        byte sequence encoding the codepoint would.
+//        byte sequence encoding the codepoint would.  See packed_utf16_char.
 class utf16_codepoint : public std::ranges::view_interface<utf16_codepoint> {
 public:
 	utf16_codepoint() = delete;
@@ -74,6 +78,30 @@ private:
 };
 
 
+// A non-owning view of a well-formed utf-16 code unit sequence in the byte order opposite that of the
+// host, encoding exactly one codepoint.  The view exposes the words as they are stored (ie, unswapped).
+class utf16_codepoint_swapped : public std::ranges::view_interface<utf16_codepoint_swapped> {
+public:
+	utf16_codepoint_swapped() = delete;
+	static std::optional<utf16_codepoint_swapped> to_utf16_codepoint_swapped(std::span<const std::uint16_t> s);
+
+	std::span<const std::uint16_t>::iterator begin() const;
+	std::span<const std::uint16_t>::iterator end() const;
+
+	constexpr bool empty() const {
+		return false;
+	}
+
+	friend class utf16_iterator_swapping;
+	friend class utf16_iterator_alt_swapping;
+private:
+	utf16_codepoint_swapped(const std::uint16_t*, const std::uint16_t*);
+	explicit utf16_codepoint_swapped(std::span<const std::uint16_t>);
+
+	std::span<const std::uint16_t> m_data;
+};
+
+
 // A non-owning view of a well-formed utf-32 code unit sequence encoding exactly one codepoint
 // TODO:  Templated on the underlying datatype?  Should I allow T's other than std::uint16_t?
 // TODO:  utf32_code_unit_sequence?  utf32_encoded_codepoint?  utf32_view?
@@ -136,6 +164,88 @@ private:
 };
 
 
+// A well-formed utf-8 code unit sequence encoding exactly one codepoint, held by value.  Unlike
+// utf8_codepoint, which holds a 16-byte span pointing into the source, this is 4 bytes, does not keep the
+// source alive, and is cheap to collect into vectors (ex, a tokenizer's output).  Unused trailing bytes
+// are 0; the length is carried by the marker bits of the leading byte, so no separate field is needed.
+// Default-constructs to U+0000.
+class packed_utf8_char {
+public:
+	packed_utf8_char() = default;
+	static std::optional<packed_utf8_char> to_packed_utf8_char(std::span<const std::uint8_t> s);
+	explicit packed_utf8_char(utf8_codepoint);
+
+	constexpr int size() const noexcept {
+		return size_utf8_multibyte_seq_from_leading_byte(m_data[0]);
+	}
+	constexpr std::uint8_t operator[](int i) const noexcept {
+		return m_data[i];
+	}
+	constexpr std::array<std::uint8_t,4>::const_iterator begin() const noexcept {
+		return m_data.begin();
+	}
+	constexpr std::array<std::uint8_t,4>::const_iterator end() const noexcept {
+		return m_data.begin() + size();
+	}
+
+	friend bool operator==(const packed_utf8_char&, const packed_utf8_char&) = default;
+
+	template<typename T>
+	friend class utf_iterator;
+
+	friend class utf8_iterator_alt;
+private:
+	// Unchecked; s must be a valid sequence
+	constexpr explicit packed_utf8_char(std::span<const std::uint8_t> s) noexcept {
+		for (std::size_t i=0; i<s.size(); ++i) {
+			m_data[i] = s[i];
+		}
+	}
+
+	std::array<std::uint8_t,4> m_data {};
+};
+static_assert(sizeof(packed_utf8_char) == 4);
+
+
+// As packed_utf8_char, for utf-16.  The second word is 0 unless the first is a leading surrogate.
+class packed_utf16_char {
+public:
+	packed_utf16_char() = default;
+	static std::optional<packed_utf16_char> to_packed_utf16_char(std::span<const std::uint16_t> s);
+	explicit packed_utf16_char(utf16_codepoint);
+
+	constexpr int size() const noexcept {
+		return is_valid_utf16_surrogate_pair_leading(m_data[0]) ? 2 : 1;
+	}
+	constexpr std::uint16_t operator[](int i) const noexcept {
+		return m_data[i];
+	}
+	constexpr std::array<std::uint16_t,2>::const_iterator begin() const noexcept {
+		return m_data.begin();
+	}
+	constexpr std::array<std::uint16_t,2>::const_iterator end() const noexcept {
+		return m_data.begin() + size();
+	}
+
+	friend bool operator==(const packed_utf16_char&, const packed_utf16_char&) = default;
+
+	template<typename T>
+	friend class utf_iterator;
+
+	friend class utf16_iterator_alt;
+private:
+	// Unchecked; s must be a valid sequence
+	constexpr explicit packed_utf16_char(std::span<const std::uint16_t> s) noexcept {
+		for (std::size_t i=0; i<s.size(); ++i) {
+			m_data[i] = s[i];
+		}
+	}
+
+	std::array<std::uint16_t,2> m_data {};
+};
+static_assert(sizeof(packed_utf16_char) == 4);
+
+
 // TODO:  My vocabulary is off:  "Because surrogate code points are not included in the set of Unicode
 // scalar values, UTF-32 code units in the range 0000D80016..0000DFFF16 are ill-formed."  Unpaired
 // surrogates _are_ valid "codepoints."  Also, "In the Unicode Standard, the codespace consists of the
@@ -159,12 +269,29 @@ public:
 	// TODO:  Do these make sense?  Maybe the views should know how to extract their own codepoint values
 	explicit codepoint(utf8_codepoint);
 	explicit codepoint(utf16_codepoint);
+	explicit codepoint(utf16_codepoint_swapped);
 	explicit codepoint(utf32_codepoint);
 	explicit codepoint(utf32_codepoint_swapped);
+	// Decoded from the packed bytes; the source buffer is not touched
+	constexpr explicit codepoint(packed_utf8_char) noexcept;
+	constexpr explicit codepoint(packed_utf16_char) noexcept;
+
+	static constexpr std::optional<codepoint> to_codepoint(std::uint32_t val) noexcept {
+		if (!is_valid_cp(val)) {
+			return std::nullopt;
+		}
+		return codepoint(val);
+	}
 
-	static std::optional<codepoint> to_codepoint(std::uint32_t val) noexcept;
+	// For values the caller has already validated (ex, just decoded from input that passed validate_utf8):
+	// skips the is_valid_cp() test and the optional.  Undefined if val is not a valid codepoint.
+	static constexpr codepoint to_codepoint_unchecked(std::uint32_t val) noexcept {
+		return codepoint(val);
+	}
 
-	std::uint32_t get() const noexcept;
+	constexpr std::uint32_t get() const noexcept {
+		return m_val;
+	}
 
 	friend std::strong_ordering operator<=>(const codepoint&,const codepoint&) = default;
 	
@@ -173,13 +300,15 @@ public:
 
 	friend class utf8_iterator_alt;
 	friend class utf16_iterator_alt;
+	friend class utf16_iterator_swapping;
+	friend class utf16_iterator_alt_swapping;
 	friend class utf32_iterator_alt;
 	friend class utf32_iterator_swapping;
 	friend class utf32_iterator_alt_swapping;
 private:
 	// Private because no validation is performed.  The value must be a valid codepoint.  Users should create
-	// codepoints via the static member to_codepoint(T).
-	explicit codepoint(std::uint32_t val) : m_val(val) {}
+	// codepoints via the static member to_codepoint(T), or to_codepoint_unchecked(T) for trusted values.
+	constexpr explicit codepoint(std::uint32_t val) : m_val(val) {}
 
 	// Assumes valid utf-8
 	explicit codepoint(std::span<const std::uint8_t>);
@@ -194,8 +323,71 @@ private:
 	std::uint32_t m_val {};
 };
 
+constexpr codepoint::codepoint(packed_utf8_char u8) noexcept {
+	const int sz = u8.size();
+	m_val = payload_utf8_leading_byte(u8[0], sz);
+	for (int i=1; i<sz; ++i) {
+		m_val = (m_val<<6) | payload_utf8_trailing_byte(u8[i]);
+	}
+}
+
+constexpr codepoint::codepoint(packed_utf16_char u16) noexcept {
+	if (u16.size() == 1) {
+		m_val = utf16_to_codepoint_value(u16[0]);
+	} else {
+		m_val = utf16_to_codepoint_value(u16[0],u16[1]);
+	}
+}
 
 
+// A string literal that is checked to be well-formed utf-8 at compile time:
+//   constexpr utf8_literal greeting {u8"Grüß Gott"};
+// An ill-formed literal (ex, "\xC0\x80") is a compile error naming utf8_literal_is_ill_formed.  Works w/
+// both char and char8_t literals; the terminating 0 is not part of the literal.  An array w/o a
+// terminating 0 (ex, const char a[2] {'h','i'}) is a compile error naming
+// utf8_literal_is_not_nul_terminated, rather than silently losing its last character.
+template<typename CharT>
+concept utf8_literal_char = std::same_as<CharT,char> || std::same_as<CharT,char8_t>;
 
+// Deliberately not constexpr (and never defined):  calling one from the consteval constructor of
+// utf8_literal is what turns a bad literal into a compile error.
+void utf8_literal_is_ill_formed();
+void utf8_literal_is_not_nul_terminated();
 
+template<utf8_literal_char CharT>
+class utf8_literal {
+public:
+	template<std::size_t N>
+	consteval utf8_literal(const CharT (&s)[N]) : m_p(s), m_sz(N-1) {
+		if (s[N-1] != CharT {}) {
+			utf8_literal_is_not_nul_terminated();
+		}
+		std::size_t i {0};
+		while (i < m_sz) {
+			// The predicates take std::uint8_t; reinterpret_cast is not allowed here, so copy
+			std::array<std::uint8_t,4> w {};
+			const std::size_t n = (m_sz-i < 4) ? (m_sz-i) : 4;
+			for (std::size_t k=0; k<n; ++k) {
+				w[k] = static_cast<std::uint8_t>(s[i+k]);
+			}
+			std::optional<int> sz = begins_with_valid_utf8({w.data(), n});
+			if (!sz) {
+				utf8_literal_is_ill_formed();
+			}
+			i += *sz;
+		}
+	}
 
+	constexpr std::basic_string_view<CharT> view() const noexcept {
+		return {m_p, m_sz};
+	}
+	constexpr std::size_t size() const noexcept {
+		return m_sz;
+	}
+	std::span<const std::uint8_t> bytes() const noexcept {
+		return {reinterpret_cast<const std::uint8_t*>(m_p), m_sz};
+	}
+private:
+	const CharT* m_p {};
+	std::size_t m_sz {};
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <array>
+
+// Whole-buffer validation.  Unlike the iterators, these only answer "where is the first problem?";
+// they return the index of the first code unit that is not part of a well-formed code unit sequence,
+// or s.size() if there is none.
+
+
+// Validates s as utf-8.  Blocks of ascii are skipped w/ SSE2; everything else runs through the
+// table-driven decoder (see begins_with_valid_utf8_dfa) w/o stopping between sequences.
+std::size_t validate_utf8(std::span<const std::uint8_t> s);
+
+// Why a utf-8 subsequence is ill-formed.  The subsequences are the maximal subparts that
+// utf8_iterator_alt reports as errors (one U+FFFD each); ex E0 80 is two errors, an overlong E0 and a
+// lone_continuation 80.
+enum class utf8_error_class {
+	lone_continuation,  // 80..BF where a sequence should begin
+	bad_leading,        // C0, C1, F5..FF, which never appear in utf-8
+	overlong,           // E0 80..9F, F0 80..8F:  a shorter sequence exists for the codepoint
+	surrogate,          // ED A0..BF:  U+D800..U+DFFF
+	too_large,          // F4 90..BF:  past U+10FFFF
+	truncated,          // The start of a valid sequence cut off by a byte that can't continue it, or by the end
+};
+inline constexpr std::size_t n_utf8_error_classes = 6;
+
+struct utf8_scan_report {
+	std::size_t n_errors {};  // Ill-formed subsequences
+	std::array<std::size_t,n_utf8_error_classes> n_errors_by_class {};  // Indexed by utf8_error_class
+	std::size_t first_error {};  // Offsets of the first & last ill-formed subsequences, or s.size() if none
+	std::size_t last_error {};
+	std::array<std::size_t,4> n_seq_by_size {};  // Well-formed sequences of 1, 2, 3 and 4 bytes
+
+	bool is_valid() const noexcept { return n_errors == 0; }
+	std::size_t n_errors_of(utf8_error_class c) const noexcept { return n_errors_by_class[static_cast<std::size_t>(c)]; }
+};
+
+// Validates s as utf-8 and, in the same pass, counts the well-formed sequences by size and the
+// ill-formed subsequences by class.  Blocks of ascii are skipped w/ SSE2 as in validate_utf8, and the
+// lengths in other valid blocks are tallied from the leading bytes w/ SSE2; only blocks containing
+// errors are classified one sequence at a time.
+utf8_scan_report scan_utf8(std::span<const std::uint8_t> s);
+
+// Validates s as utf-16 in the byte order of the host, including the pairing of surrogates
+std::size_t validate_utf16(std::span<const std::uint16_t> s);
+
+// Validates s as utf-16 in the byte order opposite that of the host, w/o modifying it.  Unlike
+// byteswap_and_validate_utf16 it needs no destination, so a big-endian input of any size is checked in
+// one pass w/o a copy.
+std::size_t validate_utf16_swapped(std::span<const std::uint16_t> s);
+
+// Byte-swaps src into dest (see byteswap_utf16) and, in the same pass, validates the swapped words as
+// utf-16.  All of src is swapped even if it is ill-formed.  For reading utf-16 in the byte order
+// opposite that of the host without a separate validation pass over the converted data.
+std::size_t byteswap_and_validate_utf16(std::span<const std::uint16_t> src, std::span<std::uint16_t> dest);
+
+// As byteswap_and_validate_utf16, for utf-32
+std::size_t byteswap_and_validate_utf32(std::span<const std::uint32_t> src, std::span<std::uint32_t> dest);
+
+
+// Validates s as utf-32 in the byte order of the host
+std::size_t validate_utf32(std::span<const std::uint32_t> s);
+
+// Validates s as utf-32 in the byte order opposite that of the host, w/o modifying it
+std::size_t validate_utf32_swapped(std::span<const std::uint32_t> s);
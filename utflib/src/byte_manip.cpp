@@ -0,0 +1,46 @@
+#include "utflib/byte_manip.h"
+
+#include "simd.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+
+void byteswap_utf16(std::span<const std::uint16_t> src, std::span<std::uint16_t> dest) {
+	std::size_t i {0};
+#ifdef UTFLIB_SSE2
+	for (; i+8 <= src.size(); i+=8) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data()+i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest.data()+i), v);
+	}
+#endif
+	for (; i<src.size(); ++i) {
+		dest[i] = reverse_bytes(src[i]);
+	}
+}
+
+void byteswap_utf16(std::span<std::uint16_t> s) {
+	byteswap_utf16(s, s);
+}
+
+void byteswap_utf32(std::span<const std::uint32_t> src, std::span<std::uint32_t> dest) {
+	std::size_t i {0};
+#ifdef UTFLIB_SSE2
+	for (; i+4 <= src.size(); i+=4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data()+i));
+		// Swap the 16-bit halves of each dword, then the bytes of each half
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2,3,0,1));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest.data()+i), v);
+	}
+#endif
+	for (; i<src.size(); ++i) {
+		dest[i] = reverse_bytes(src[i]);
+	}
+}
+
+void byteswap_utf32(std::span<std::uint32_t> s) {
+	byteswap_utf32(s, s);
+}
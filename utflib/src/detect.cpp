@@ -0,0 +1,245 @@
+#include "utflib/detect.h"
+
+#include "utflib/low_level.h"
+#include "simd.h"
+#include "utf8_dfa.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <bit>
+
+
+namespace {
+
+// Byte order marks, longest first, since the utf-32le BOM begins w/ the utf-16le BOM
+struct bom {
+	std::array<std::uint8_t,4> bytes;
+	std::size_t size;
+	utf_encoding encoding;
+};
+constexpr std::array<bom,5> boms {{
+	{{0x00u,0x00u,0xFEu,0xFFu}, 4, utf_encoding::utf32be},
+	{{0xFFu,0xFEu,0x00u,0x00u}, 4, utf_encoding::utf32le},
+	{{0xEFu,0xBBu,0xBFu,0x00u}, 3, utf_encoding::utf8},
+	{{0xFEu,0xFFu,0x00u,0x00u}, 2, utf_encoding::utf16be},
+	{{0xFFu,0xFEu,0x00u,0x00u}, 2, utf_encoding::utf16le}
+}};
+
+std::optional<bom> find_bom(std::span<const std::uint8_t> s) {
+	for (const bom& b : boms) {
+		if (s.size() >= b.size && std::equal(b.bytes.begin(), b.bytes.begin()+b.size, s.begin())) {
+			return b;
+		}
+	}
+	return std::nullopt;
+}
+
+// Tracks surrogate pairing across the words of a utf-16 sequence.  Every unpaired surrogate, and every
+// leading surrogate followed by something other than a trailing surrogate, is one error.
+struct utf16_pairing {
+	std::size_t n_errors {0};
+	bool expect_trailing {false};
+
+	void feed(std::uint16_t w) {
+		if (is_valid_utf16_surrogate_pair_leading(w)) {
+			n_errors += expect_trailing;
+			expect_trailing = true;
+		} else if (is_valid_utf16_surrogate_pair_trailing(w)) {
+			n_errors += !expect_trailing;
+			expect_trailing = false;
+		} else {
+			n_errors += expect_trailing;
+			expect_trailing = false;
+		}
+	}
+	// Equivalent to feeding one or more words none of which are surrogates
+	void feed_non_surrogates() {
+		n_errors += expect_trailing;
+		expect_trailing = false;
+	}
+};
+
+// Code units are assembled from the bytes explicitly, so none of this depends on the byte order of
+// the host.
+std::uint16_t load_u16(const std::uint8_t* p, bool le) {
+	return le ? static_cast<std::uint16_t>(p[0] | (p[1]<<8))
+		: static_cast<std::uint16_t>((p[0]<<8) | p[1]);
+}
+std::uint32_t load_u32(const std::uint8_t* p, bool le) {
+	return le ? (std::uint32_t{p[0]} | (std::uint32_t{p[1]}<<8) | (std::uint32_t{p[2]}<<16) | (std::uint32_t{p[3]}<<24))
+		: ((std::uint32_t{p[0]}<<24) | (std::uint32_t{p[1]}<<16) | (std::uint32_t{p[2]}<<8) | std::uint32_t{p[3]});
+}
+
+// Everything about the fixed-width encodings that can be gathered in one pass.  n_zero[k] is the
+// number of 0x00 bytes at offsets == k (mod 4).
+struct fixed_width_stats {
+	std::array<std::size_t,4> n_zero {};
+	utf16_pairing utf16le;
+	utf16_pairing utf16be;
+	std::size_t utf32le_errors {0};
+	std::size_t utf32be_errors {0};
+};
+
+// [i,j) is a range of byte offsets into s; i must be a multiple of 4
+void scan_fixed_width_scalar(std::span<const std::uint8_t> s, std::size_t i, std::size_t j, fixed_width_stats& st) {
+	for (std::size_t k=i; k<j; ++k) {
+		st.n_zero[k%4] += (s[k]==0u);
+	}
+	for (std::size_t k=i; k+2<=j; k+=2) {
+		st.utf16le.feed(load_u16(s.data()+k, true));
+		st.utf16be.feed(load_u16(s.data()+k, false));
+	}
+	for (std::size_t k=i; k+4<=j; k+=4) {
+		st.utf32le_errors += !is_valid_utf32_codepoint(load_u32(s.data()+k, true));
+		st.utf32be_errors += !is_valid_utf32_codepoint(load_u32(s.data()+k, false));
+	}
+}
+
+fixed_width_stats scan_fixed_width(std::span<const std::uint8_t> s) {
+	fixed_width_stats st {};
+	std::size_t i {0};
+#ifdef UTFLIB_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i+16<=s.size(); i+=16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i));
+		const unsigned z = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+		st.n_zero[0] += std::popcount(z & 0x1111u);
+		st.n_zero[1] += std::popcount(z & 0x2222u);
+		st.n_zero[2] += std::popcount(z & 0x4444u);
+		st.n_zero[3] += std::popcount(z & 0x8888u);
+
+		// Bytes on [0xD8,0xDF].  In a surrogate, this is the high-order byte of the word:  at the odd
+		// offsets for le, the even offsets for be.  Most blocks have none in either position.
+		const __m128i hi5 = _mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xF8u)));
+		const unsigned sg = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi5, _mm_set1_epi8(static_cast<char>(0xD8u)))));
+		if (sg & 0xAAAAu) {
+			for (std::size_t k=i; k<i+16; k+=2) {
+				st.utf16le.feed(load_u16(s.data()+k, true));
+			}
+		} else {
+			st.utf16le.feed_non_surrogates();
+		}
+		if (sg & 0x5555u) {
+			for (std::size_t k=i; k<i+16; k+=2) {
+				st.utf16be.feed(load_u16(s.data()+k, false));
+			}
+		} else {
+			st.utf16be.feed_non_surrogates();
+		}
+
+		for (std::size_t k=i; k<i+16; k+=4) {
+			st.utf32le_errors += !is_valid_utf32_codepoint(load_u32(s.data()+k, true));
+			st.utf32be_errors += !is_valid_utf32_codepoint(load_u32(s.data()+k, false));
+		}
+	}
+#endif
+	scan_fixed_width_scalar(s, i, s.size(), st);
+	return st;
+}
+
+// Number of bytes not part of a valid utf-8 sequence
+std::size_t count_utf8_errors(std::span<const std::uint8_t> s) {
+	std::size_t n_errors {0};
+	const std::uint8_t* p = s.data();
+	const std::uint8_t* const p_end = s.data() + s.size();
+	while (p != p_end) {
+#ifdef UTFLIB_SSE2
+		if ((p_end-p) >= 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const unsigned non_ascii = static_cast<unsigned>(_mm_movemask_epi8(v));
+			if (non_ascii == 0) {
+				p += 16;
+				continue;
+			}
+			p += std::countr_zero(non_ascii);
+		}
+#endif
+		std::optional<int> sz = utf8_dfa::sequence_size(p, p_end);
+		if (sz) {
+			p += *sz;
+		} else {
+			++n_errors;
+			++p;
+		}
+	}
+	return n_errors;
+}
+
+// 1 - n/d, clamped to [0,1]; 1 if there is nothing to judge
+double one_minus_ratio(std::size_t n, std::size_t d) {
+	if (d == 0) {
+		return 1.0;
+	}
+	return std::clamp(1.0 - static_cast<double>(n)/static_cast<double>(d), 0.0, 1.0);
+}
+
+}  // namespace
+
+
+detected_encoding detect_encoding(std::span<const std::uint8_t> s, std::size_t max_prefix) {
+	std::optional<bom> b = find_bom(s);
+	if (b) {
+		s = s.subspan(b->size);
+	}
+	const bool is_cut = s.size() > max_prefix;
+
+	// The utf-8 prefix is cut on a codepoint boundary; the fixed-width one at whatever max_prefix is.
+	// Neither the partial code unit nor the unpaired leading surrogate this may leave at the end of the
+	// fixed-width prefix is held against it.
+	const std::span<const std::uint8_t> s8 = truncate_utf8(s, max_prefix);
+	const std::span<const std::uint8_t> sfw = s.first(std::min(s.size(), max_prefix));
+
+	const std::size_t utf8_errors = count_utf8_errors(s8);
+	fixed_width_stats st = scan_fixed_width(sfw);
+
+	std::size_t n16 = sfw.size()/2;
+	std::size_t n32 = sfw.size()/4;
+	std::size_t utf16le_errors = st.utf16le.n_errors;
+	std::size_t utf16be_errors = st.utf16be.n_errors;
+	std::size_t utf32le_errors = st.utf32le_errors;
+	std::size_t utf32be_errors = st.utf32be_errors;
+	if (!is_cut) {
+		utf16le_errors += st.utf16le.expect_trailing;
+		utf16be_errors += st.utf16be.expect_trailing;
+		if (sfw.size()%2 != 0) {
+			++n16;
+			++utf16le_errors;
+			++utf16be_errors;
+		}
+		if (sfw.size()%4 != 0) {
+			++n32;
+			++utf32le_errors;
+			++utf32be_errors;
+		}
+	}
+
+	// The score is (fraction of code units that are valid)*(plausibility), where the plausibility
+	// penalizes 0x00 bytes where the encoding would not put them in text.  Text rarely contains U+0000,
+	// so any 0x00 byte counts against utf-8.  Utf-16 of ascii or latin-1 text has 0x00 in the
+	// high-order byte of a word but (except for U+0000) never in the low-order one; reading it in the
+	// wrong byte order gives codepoints like U+4100, which are valid but rare.  Utf-32 read in the
+	// wrong order is almost always invalid, so all that is left to penalize is U+0000.
+	const std::size_t nz = st.n_zero[0] + st.n_zero[1] + st.n_zero[2] + st.n_zero[3];
+	detected_encoding r {};
+	r.bom_size = b ? b->size : 0;
+	r.ranked = {{
+		{utf_encoding::utf8, one_minus_ratio(utf8_errors, s8.size())*one_minus_ratio(nz, sfw.size())},
+		{utf_encoding::utf16le, one_minus_ratio(utf16le_errors, n16)*one_minus_ratio(st.n_zero[0]+st.n_zero[2], n16)},
+		{utf_encoding::utf16be, one_minus_ratio(utf16be_errors, n16)*one_minus_ratio(st.n_zero[1]+st.n_zero[3], n16)},
+		{utf_encoding::utf32le, one_minus_ratio(utf32le_errors, n32)*one_minus_ratio(st.n_zero[0], n32)},
+		{utf_encoding::utf32be, one_minus_ratio(utf32be_errors, n32)*one_minus_ratio(st.n_zero[3], n32)}
+	}};
+
+	std::stable_sort(r.ranked.begin(), r.ranked.end(),
+		[](const encoding_guess& lhs, const encoding_guess& rhs) { return lhs.score > rhs.score; });
+	if (b) {
+		auto it = std::find_if(r.ranked.begin(), r.ranked.end(),
+			[&](const encoding_guess& g) { return g.encoding == b->encoding; });
+		it->score = 1.0;
+		std::rotate(r.ranked.begin(), it, it+1);
+	}
+	return r;
+}
@@ -114,6 +114,14 @@ std::optional<utf8_codepoint> utf8_iterator_alt::get() const {
 	return utf8_codepoint(next_valid);
 }
 
+std::optional<packed_utf8_char> utf8_iterator_alt::get_packed() const {
+	std::span<const std::uint8_t> next_valid = seek_to_first_valid_utf8_sequence({m_p,static_cast<std::size_t>(m_pend-m_p)});
+	if (m_p != next_valid.data() || next_valid.size()==0) {
+		return std::nullopt;
+	}
+	return packed_utf8_char(next_valid);
+}
+
 std::span<const std::uint8_t> utf8_iterator_alt::get_underlying() const {
 	utf8_iterator_alt it = *this;
 	it.go_next();
@@ -205,6 +213,14 @@ std::optional<utf16_codepoint> utf16_iterator_alt::get() const {
 	return utf16_codepoint(next_valid);
 }
 
+std::optional<packed_utf16_char> utf16_iterator_alt::get_packed() const {
+	std::span<const std::uint16_t> next_valid = seek_to_first_valid_utf16_sequence({m_p,m_pend});
+	if (m_p != next_valid.data() || next_valid.size()==0) {
+		return std::nullopt;
+	}
+	return packed_utf16_char(next_valid);
+}
+
 std::span<const std::uint16_t> utf16_iterator_alt::get_underlying() const {
 	utf16_iterator_alt it = *this;
 	it.go_next();
@@ -213,6 +229,173 @@ std::span<const std::uint16_t> utf16_iterator_alt::get_underlying() const {
 
 
 
+//
+// utf16_iterator_swapping
+//
+utf16_iterator_swapping::utf16_iterator_swapping(std::span<const std::uint16_t> s) {
+	m_p = s.data();
+	m_pbeg = s.data();
+	m_pend = s.data() + s.size();
+}
+
+bool utf16_iterator_swapping::is_finished() const {
+	return m_p == m_pend;
+}
+
+bool utf16_iterator_swapping::at_start() const {
+	return m_p == m_pbeg;
+}
+
+// false if it didn't go anywhere (=>is_finished() prior to the call)
+bool utf16_iterator_swapping::go_next() {
+	if (is_finished()) {
+		return false;
+	}
+
+	std::optional<int> sz = begins_with_valid_utf16_reversed({m_p,m_pend});
+	if (sz) {
+		m_p += *sz;
+	} else {
+		// On the start of an invalid subsequence; step over it onto the next valid sequence (or the end)
+		m_p = seek_to_first_valid_utf16_sequence_reversed({m_p+1,m_pend}).data();
+	}
+	return true;
+}
+
+// false if it didn't go anywhere (=>at_start() prior to the call)
+bool utf16_iterator_swapping::go_prev() {
+	if (at_start()) {
+		return false;
+	}
+
+	// Same approach as utf_iterator::go_prev()
+	const std::uint16_t* p = m_p;
+	std::optional<int> sz = std::nullopt;
+	while (true) {
+		--p;
+		sz = begins_with_valid_utf16_reversed({p,m_pend});
+		if (p==m_pbeg || sz) {
+			break;
+		}
+	}
+	if (sz && p+*sz != m_p) {
+		// There is an invalid subsequence between the valid sequence at p and m_p; move to its start
+		p += *sz;
+	}
+
+	m_p = p;
+	return true;
+}
+
+std::optional<codepoint> utf16_iterator_swapping::get_codepoint() const {
+	std::optional<int> sz = begins_with_valid_utf16_reversed({m_p,m_pend});
+	if (!sz) {
+		return std::nullopt;
+	}
+	if (*sz == 1) {
+		return codepoint(utf16_to_codepoint_value(reverse_bytes(*m_p)));
+	}
+	return codepoint(utf16_to_codepoint_value(reverse_bytes(*m_p), reverse_bytes(*(m_p+1))));
+}
+
+std::optional<utf16_codepoint_swapped> utf16_iterator_swapping::get() const {
+	std::optional<int> sz = begins_with_valid_utf16_reversed({m_p,m_pend});
+	if (!sz) {
+		return std::nullopt;
+	}
+	return utf16_codepoint_swapped(m_p, m_p+*sz);
+}
+
+std::span<const std::uint16_t> utf16_iterator_swapping::get_underlying() const {
+	utf16_iterator_swapping it = *this;
+	it.go_next();
+	return {m_p, it.m_p};
+}
+
+
+//
+// utf16_iterator_alt_swapping
+//
+utf16_iterator_alt_swapping::utf16_iterator_alt_swapping(std::span<const std::uint16_t> s) {
+	m_p = s.data();
+	m_pbeg = s.data();
+	m_pend = s.data() + s.size();
+}
+
+bool utf16_iterator_alt_swapping::is_finished() const {
+	return m_p == m_pend;
+}
+
+bool utf16_iterator_alt_swapping::at_start() const {
+	return m_p == m_pbeg;
+}
+
+// false if it didn't go anywhere (=>is_finished() prior to the call)
+bool utf16_iterator_alt_swapping::go_next() {
+	if (m_p == m_pend) {
+		return false;
+	}
+
+	std::optional<int> sz = begins_with_valid_utf16_reversed({m_p,m_pend});
+	if (sz) {
+		m_p += *sz;
+	} else {
+		// m_p is on an invalid code unit
+		++m_p;
+	}
+
+	return true;
+}
+
+// false if it didn't go anywhere (=>at_start() prior to the call)
+bool utf16_iterator_alt_swapping::go_prev() {
+	if (m_p == m_pbeg) {
+		return false;
+	}
+
+	--m_p;
+	if (m_p==m_pbeg) {
+		return true;
+	}
+	if (is_valid_utf16_codepoint(reverse_bytes(*m_p))) {
+		return true;
+	}
+	if (is_valid_utf16_surrogate_pair_leading(reverse_bytes(*(m_p-1)))
+		&& is_valid_utf16_surrogate_pair_trailing(reverse_bytes(*m_p))) {
+		--m_p;
+		return true;
+	}
+	// invalid
+
+	return true;
+}
+
+std::optional<codepoint> utf16_iterator_alt_swapping::get_codepoint() const {
+	std::optional<int> sz = begins_with_valid_utf16_reversed({m_p,m_pend});
+	if (!sz) {
+		return std::nullopt;
+	}
+	if (*sz == 1) {
+		return codepoint(utf16_to_codepoint_value(reverse_bytes(*m_p)));
+	}
+	return codepoint(utf16_to_codepoint_value(reverse_bytes(*m_p), reverse_bytes(*(m_p+1))));
+}
+
+std::optional<utf16_codepoint_swapped> utf16_iterator_alt_swapping::get() const {
+	std::optional<int> sz = begins_with_valid_utf16_reversed({m_p,m_pend});
+	if (!sz) {
+		return std::nullopt;
+	}
+	return utf16_codepoint_swapped(m_p, m_p+*sz);
+}
+
+std::span<const std::uint16_t> utf16_iterator_alt_swapping::get_underlying() const {
+	utf16_iterator_alt_swapping it = *this;
+	it.go_next();
+	return {m_p, it.m_p};
+}
+
+
 //
 // utf32_iterator_swapping
 //
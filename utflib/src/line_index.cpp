@@ -0,0 +1,63 @@
+#include "utflib/line_index.h"
+
+#include "utflib/low_level.h"
+#include "simd.h"
+#include "utf8_dfa.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <optional>
+#include <bit>
+
+
+std::vector<utf8_line> index_utf8_lines(std::span<const std::uint8_t> s) {
+	std::vector<utf8_line> lines;
+	if (s.empty()) {
+		return lines;
+	}
+
+	const std::uint8_t* const p_beg = s.data();
+	const std::uint8_t* const p_end = s.data() + s.size();
+	const std::uint8_t* p = p_beg;
+	utf8_line curr {0, 0, true};
+
+	while (p != p_end) {
+#ifdef UTFLIB_SSE2
+		if ((p_end-p) >= 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const unsigned non_ascii = static_cast<unsigned>(_mm_movemask_epi8(v));
+			const unsigned nl = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x0A))));
+			if ((non_ascii|nl) == 0) {
+				curr.n_cp += 16;
+				p += 16;
+				continue;
+			}
+			// Consume the ascii prefix of the block up to whichever comes first, the first 0x0A or the
+			// first non-ascii byte, then fall through to the scalar code to deal with that byte.
+			const int n_ascii = std::countr_zero(non_ascii|nl);
+			curr.n_cp += n_ascii;
+			p += n_ascii;
+		}
+#endif
+		if (*p == 0x0Au) {
+			++p;
+			lines.push_back(curr);
+			curr = {static_cast<std::size_t>(p-p_beg), 0, true};
+			continue;
+		}
+		std::optional<int> sz = utf8_dfa::sequence_size(p, p_end);
+		if (sz) {
+			++curr.n_cp;
+			p += *sz;
+		} else {
+			curr.is_valid = false;
+			++p;
+		}
+	}
+
+	if (curr.offset != s.size()) {
+		lines.push_back(curr);
+	}
+	return lines;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Private to the library; not installed with the public headers.
+// The bulk routines use SSE2 when it is part of the target's baseline instruction set (always the
+// case for x86-64) and fall back to scalar code everywhere else.  Nothing newer than SSE2 is used so
+// that no per-file architecture flags or runtime dispatch are needed.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTFLIB_SSE2 1
+#include <emmintrin.h>
+#endif
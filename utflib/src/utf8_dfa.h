@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <optional>
+
+// Private to the library; the table-driven utf-8 decoder behind begins_with_valid_utf8_dfa and the scalar
+// paths of the whole-buffer routines.  See low_level.h.
+//
+// Byte classes (Hoehrmann's numbering, which makes (0xFF >> class) & b the payload of a leading byte):
+//   0:  00..7F        1:  80..8F        9:  90..9F        7:  A0..BF
+//   8:  C0..C1, F5..FF (never valid)    2:  C2..DF
+//   10: E0            3:  E1..EC, EE..EF                  4:  ED
+//   11: F0            6:  F1..F3        5:  F4
+// States are premultiplied by the number of classes so that the transition is a single lookup at
+// state + class.
+
+namespace utf8_dfa {
+
+inline constexpr std::uint8_t n_classes = 12;
+
+enum state : std::uint8_t {
+	accept = 0*n_classes,
+	reject = 1*n_classes,
+	need_1 = 2*n_classes,  // 80..BF then done
+	need_2 = 3*n_classes,  // 80..BF then need_1
+	after_e0 = 4*n_classes,  // A0..BF then need_1
+	after_ed = 5*n_classes,  // 80..9F then need_1
+	after_f0 = 6*n_classes,  // 90..BF then need_2
+	need_3 = 7*n_classes,  // 80..BF then need_2 (after F1..F3)
+	after_f4 = 8*n_classes,  // 80..8F then need_2
+};
+inline constexpr int n_states = 9;
+
+inline constexpr std::array<std::uint8_t,256> byte_class = [](){
+	std::array<std::uint8_t,256> c {};
+	for (int b=0; b<256; ++b) {
+		if (b <= 0x7F) { c[b] = 0; }
+		else if (b <= 0x8F) { c[b] = 1; }
+		else if (b <= 0x9F) { c[b] = 9; }
+		else if (b <= 0xBF) { c[b] = 7; }
+		else if (b <= 0xC1) { c[b] = 8; }
+		else if (b <= 0xDF) { c[b] = 2; }
+		else if (b == 0xE0) { c[b] = 10; }
+		else if (b == 0xED) { c[b] = 4; }
+		else if (b <= 0xEF) { c[b] = 3; }
+		else if (b == 0xF0) { c[b] = 11; }
+		else if (b <= 0xF3) { c[b] = 6; }
+		else if (b == 0xF4) { c[b] = 5; }
+		else { c[b] = 8; }
+	}
+	return c;
+}();
+
+// Built from Table 3-7 (low_level.h) rather than typed in
+inline constexpr std::array<std::uint8_t,n_states*n_classes> transition = [](){
+	std::array<std::uint8_t,n_states*n_classes> t {};
+	for (auto& e : t) {
+		e = reject;
+	}
+	auto set = [&](state from, int cls, state to) { t[from + cls] = to; };
+	set(accept, 0, accept);
+	set(accept, 2, need_1);
+	set(accept, 3, need_2);
+	set(accept, 10, after_e0);
+	set(accept, 4, after_ed);
+	set(accept, 11, after_f0);
+	set(accept, 6, need_3);
+	set(accept, 5, after_f4);
+	for (int cls : {1, 9, 7}) {  // 80..BF
+		set(need_1, cls, accept);
+		set(need_2, cls, need_1);
+		set(need_3, cls, need_2);
+	}
+	set(after_e0, 7, need_1);
+	set(after_ed, 1, need_1);
+	set(after_ed, 9, need_1);
+	set(after_f0, 9, need_2);
+	set(after_f0, 7, need_2);
+	set(after_f4, 1, need_2);
+	return t;
+}();
+
+inline std::uint8_t step(std::uint8_t s, std::uint8_t b) {
+	return transition[s + byte_class[b]];
+}
+
+// As step, also accumulating the codepoint in cp
+inline std::uint8_t step(std::uint8_t s, std::uint8_t b, std::uint32_t& cp) {
+	const std::uint8_t cls = byte_class[b];
+	cp = (s != accept) ? ((b & 0x3Fu) | (cp << 6)) : ((0xFFu >> cls) & b);
+	return transition[s + cls];
+}
+
+// The size of the valid sequence at the start of [p,p_end), or nullopt if it doesn't begin w/ one
+inline std::optional<int> sequence_size(const std::uint8_t* p, const std::uint8_t* p_end) {
+	std::uint8_t s = accept;
+	for (int i=0; p+i!=p_end && i<4; ++i) {
+		s = step(s, p[i]);
+		if (s == accept) {
+			return i+1;
+		}
+		if (s == reject) {
+			return std::nullopt;
+		}
+	}
+	return std::nullopt;  // Cut off by p_end
+}
+
+}  // namespace utf8_dfa
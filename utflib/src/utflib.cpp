@@ -55,6 +55,32 @@ std::span<const std::uint16_t>::iterator utf16_codepoint::end() const {
 	return m_data.end();
 }
 
+//
+// UTF-16 swapped view
+//
+std::optional<utf16_codepoint_swapped> utf16_codepoint_swapped::to_utf16_codepoint_swapped(std::span<const std::uint16_t> s) {
+	std::optional<int> sz = begins_with_valid_utf16_reversed(s);
+	if (!sz || static_cast<std::size_t>(*sz) != s.size()) {
+		return std::nullopt;
+	}
+	return utf16_codepoint_swapped(s);
+}
+
+utf16_codepoint_swapped::utf16_codepoint_swapped(const std::uint16_t* beg, const std::uint16_t* end) {
+	m_data = std::span {beg, end};
+}
+
+utf16_codepoint_swapped::utf16_codepoint_swapped(std::span<const std::uint16_t> s) : m_data(s) {
+	//...
+}
+
+std::span<const std::uint16_t>::iterator utf16_codepoint_swapped::begin() const {
+	return m_data.begin();
+}
+std::span<const std::uint16_t>::iterator utf16_codepoint_swapped::end() const {
+	return m_data.end();
+}
+
 //
 // UTF-32 view
 //
@@ -107,6 +133,32 @@ std::span<const std::uint32_t>::iterator utf32_codepoint_swapped::end() const {
 }
 
 
+//
+// Packed utf-8 & utf-16
+//
+std::optional<packed_utf8_char> packed_utf8_char::to_packed_utf8_char(std::span<const std::uint8_t> s) {
+	if (!is_valid_utf8_single_codepoint(s)) {
+		return std::nullopt;
+	}
+	return packed_utf8_char(s);
+}
+
+packed_utf8_char::packed_utf8_char(utf8_codepoint u8) : packed_utf8_char(std::span<const std::uint8_t>(u8.begin(), u8.end())) {
+	//...
+}
+
+std::optional<packed_utf16_char> packed_utf16_char::to_packed_utf16_char(std::span<const std::uint16_t> s) {
+	if (!is_valid_utf16_single_codepoint(s)) {
+		return std::nullopt;
+	}
+	return packed_utf16_char(s);
+}
+
+packed_utf16_char::packed_utf16_char(utf16_codepoint u16) : packed_utf16_char(std::span<const std::uint16_t>(u16.begin(), u16.end())) {
+	//...
+}
+
+
 //
 // codepoint value type
 //
@@ -144,6 +196,15 @@ codepoint::codepoint(utf16_codepoint u16) {
 	}
 }
 
+codepoint::codepoint(utf16_codepoint_swapped u16) {
+	int sz = u16.size();
+	if (sz == 1) {
+		m_val = utf16_to_codepoint_value(reverse_bytes(u16[0]));
+	} else if (sz == 2) {
+		m_val = utf16_to_codepoint_value(reverse_bytes(u16[0]),reverse_bytes(u16[1]));
+	}
+}
+
 codepoint::codepoint(utf32_codepoint u32) {
 	m_val = u32[0];
 }
@@ -191,15 +252,3 @@ codepoint::codepoint(std::span<const std::uint16_t> s) {
 codepoint::codepoint(std::span<const std::uint32_t> s) {
 	m_val = s[0];
 }
-
-std::optional<codepoint> codepoint::to_codepoint(std::uint32_t val) noexcept {
-	if (!is_valid_cp(val)) {
-		return std::nullopt;
-	}
-	return codepoint(val);
-}
-
-std::uint32_t codepoint::get() const noexcept {
-	return m_val;
-}
-
@@ -0,0 +1,371 @@
+#include "utflib/validate.h"
+
+#include "utflib/low_level.h"
+#include "utflib/byte_manip.h"
+#include "simd.h"
+#include "utf8_dfa.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <bit>
+#include <algorithm>
+
+
+// Scalar utf-16 validation of s[beg,end) carrying the state of a possible leading surrogate at s[beg-1].
+// Returns the index of the first invalid word or end if none.  If swapped, each word is byte-swapped as
+// it's read.
+template<bool swapped = false>
+static std::size_t validate_utf16_range(std::span<const std::uint16_t> s, std::size_t beg, std::size_t end,
+	bool& expect_trailing) {
+	for (std::size_t i=beg; i<end; ++i) {
+		const std::uint16_t w = swapped ? reverse_bytes(s[i]) : s[i];
+		if (expect_trailing) {
+			expect_trailing = false;
+			if (is_valid_utf16_surrogate_pair_trailing(w)) {
+				continue;
+			}
+			return i-1;  // Unpaired leading surrogate
+		}
+		if (is_valid_utf16_surrogate_pair_leading(w)) {
+			expect_trailing = true;
+		} else if (!is_valid_utf16_codepoint(w)) {
+			return i;  // Unpaired trailing surrogate
+		}
+	}
+	return end;
+}
+
+std::size_t validate_utf8(std::span<const std::uint8_t> s) {
+	std::uint8_t state = utf8_dfa::accept;
+	std::size_t seq_beg {0};  // Start of the sequence the machine is in
+	std::size_t i {0};
+	while (i < s.size()) {
+#ifdef UTFLIB_SSE2
+		if (state == utf8_dfa::accept && i+16 <= s.size()) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i));
+			const unsigned non_ascii = static_cast<unsigned>(_mm_movemask_epi8(v));
+			if (non_ascii == 0) {
+				i += 16;
+				continue;
+			}
+			i += std::countr_zero(non_ascii);
+		}
+#endif
+		// Run the machine over the next 16 bytes w/o regard for where the sequences begin and end.  The
+		// only branch is the exit on reject, which valid input never takes.
+		const std::size_t blk_end = std::min(i+16, s.size());
+		for (; i<blk_end; ++i) {
+			seq_beg = (state == utf8_dfa::accept) ? i : seq_beg;
+			state = utf8_dfa::step(state, s[i]);
+			if (state == utf8_dfa::reject) {
+				return seq_beg;
+			}
+		}
+	}
+	return (state == utf8_dfa::accept) ? s.size() : seq_beg;
+}
+
+static void add_utf8_error(utf8_scan_report& r, utf8_error_class c, std::size_t offset) {
+	if (r.n_errors == 0) {
+		r.first_error = offset;
+	}
+	r.last_error = offset;
+	++r.n_errors;
+	++r.n_errors_by_class[static_cast<std::size_t>(c)];
+}
+
+// Adds the well-formed sequence or the maximal ill-formed subpart at s[i] to r and returns its size
+static std::size_t scan_utf8_sequence(std::span<const std::uint8_t> s, std::size_t i, utf8_scan_report& r) {
+	std::uint8_t state = utf8_dfa::accept;
+	std::size_t k {0};
+	for (; i+k < s.size(); ++k) {
+		state = utf8_dfa::step(state, s[i+k]);
+		if (state == utf8_dfa::accept) {
+			++r.n_seq_by_size[k];
+			return k+1;
+		}
+		if (state == utf8_dfa::reject) {
+			break;
+		}
+	}
+	// s[i,i+k) is the maximal subpart; s[i+k], if any, is the byte that can't continue it
+	utf8_error_class c = utf8_error_class::truncated;
+	if (k == 0) {
+		c = is_utf8_trailing_byte(s[i]) ? utf8_error_class::lone_continuation : utf8_error_class::bad_leading;
+	} else if (k == 1 && i+1 < s.size() && is_utf8_trailing_byte(s[i+1])) {
+		// Only the second byte has a range narrower than 80..BF (Table 3-7)
+		if (s[i] == 0xE0u || s[i] == 0xF0u) {
+			c = utf8_error_class::overlong;
+		} else if (s[i] == 0xEDu) {
+			c = utf8_error_class::surrogate;
+		} else if (s[i] == 0xF4u) {
+			c = utf8_error_class::too_large;
+		}
+	}
+	add_utf8_error(r, c, i);
+	return std::max<std::size_t>(k, 1);
+}
+
+// Adds the sizes of the sequences beginning in the 16 valid bytes at p to r
+static void count_utf8_leading_bytes(const std::uint8_t* p, utf8_scan_report& r) {
+#ifdef UTFLIB_SSE2
+	// As signed bytes, ascii is >= 0 and C0..FF (the leading bytes of multibyte sequences) is >= -64;
+	// E0.. is >= -32 and F0.. >= -16.
+	const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	const unsigned non_ascii = static_cast<unsigned>(_mm_movemask_epi8(v));
+	auto at_least = [&](int b) {
+		return std::popcount(non_ascii
+			& static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(b-1))))));
+	};
+	const int n_lead2 = at_least(-64);
+	const int n_lead3 = at_least(-32);
+	const int n_lead4 = at_least(-16);
+	r.n_seq_by_size[0] += 16 - std::popcount(non_ascii);
+	r.n_seq_by_size[1] += n_lead2 - n_lead3;
+	r.n_seq_by_size[2] += n_lead3 - n_lead4;
+	r.n_seq_by_size[3] += n_lead4;
+#else
+	for (int i=0; i<16; ++i) {
+		if (!is_utf8_trailing_byte(p[i])) {
+			++r.n_seq_by_size[(p[i] < 0x80u) ? 0 : size_utf8_multibyte_seq_from_leading_byte(p[i])-1];
+		}
+	}
+#endif
+}
+
+utf8_scan_report scan_utf8(std::span<const std::uint8_t> s) {
+	utf8_scan_report r {};
+	r.first_error = s.size();
+	r.last_error = s.size();
+	std::size_t i {0};  // Always at the start of a sequence or ill-formed subsequence
+	while (i < s.size()) {
+		if (i+16 <= s.size()) {
+#ifdef UTFLIB_SSE2
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i));
+			if (_mm_movemask_epi8(v) == 0) {
+				r.n_seq_by_size[0] += 16;
+				i += 16;
+				continue;
+			}
+#endif
+			// Run the machine over the block w/o branching (reject is absorbing), then to the end of a
+			// sequence that straddles the end of the block.  The bytes past the block are all trailing
+			// bytes, so the block's leading bytes give the sizes of all of the sequences.
+			std::uint8_t state = utf8_dfa::accept;
+			for (std::size_t j=i; j<i+16; ++j) {
+				state = utf8_dfa::step(state, s[j]);
+			}
+			std::size_t end = i+16;
+			for (; end < s.size() && state != utf8_dfa::accept && state != utf8_dfa::reject; ++end) {
+				state = utf8_dfa::step(state, s[end]);
+			}
+			if (state == utf8_dfa::accept) {
+				count_utf8_leading_bytes(s.data()+i, r);
+				i = end;
+				continue;
+			}
+		}
+		// A block w/ an error (or the last partial block):  one sequence at a time to the end of the block
+		const std::size_t blk_end = std::min(i+16, s.size());
+		while (i < blk_end) {
+			i += scan_utf8_sequence(s, i, r);
+		}
+	}
+	return r;
+}
+
+#ifdef UTFLIB_SSE2
+// Bit k of .leading (.trailing) is set if word k of the 16 words in v0,v1 is a leading (trailing)
+// surrogate.  If swapped, the words are in the opposite byte order; the masks are swapped instead of the
+// words.
+struct utf16_surrogate_bits {
+	unsigned leading;
+	unsigned trailing;
+};
+template<bool swapped = false>
+static utf16_surrogate_bits classify_utf16_surrogates(__m128i v0, __m128i v1) {
+	const __m128i top6 = _mm_set1_epi16(static_cast<short>(swapped ? 0x00FC : 0xFC00));
+	const __m128i leading = _mm_set1_epi16(static_cast<short>(swapped ? 0x00D8 : 0xD800));
+	const __m128i trailing = _mm_set1_epi16(static_cast<short>(swapped ? 0x00DC : 0xDC00));
+	const __m128i t0 = _mm_and_si128(v0, top6);
+	const __m128i t1 = _mm_and_si128(v1, top6);
+	// The compares give 0 or -1 per word; packing w/ signed saturation narrows them to one byte per word
+	// so that movemask gives one bit per word.
+	return {
+		static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(t0, leading), _mm_cmpeq_epi16(t1, leading)))),
+		static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(t0, trailing), _mm_cmpeq_epi16(t1, trailing))))
+	};
+}
+
+// Checks the pairing of the surrogates in a block of n_words words.  carry is 1 if the word before the
+// block is a leading surrogate; on return it is 1 if the last word of the block is.  Returns the offset
+// from the start of the block of the first invalid word (-1 is the word before the block), or n_words.
+static std::ptrdiff_t check_utf16_pairing(utf16_surrogate_bits b, unsigned& carry, int n_words) {
+	const unsigned all = (1u << n_words) - 1u;
+	// Every word after a leading surrogate must be a trailing surrogate, and no other word may be
+	const unsigned expect_trailing = ((b.leading << 1) | carry) & all;
+	const unsigned bad = b.trailing ^ expect_trailing;
+	if (bad != 0) {
+		const int k = std::countr_zero(bad);
+		// Either a leading surrogate at k-1 w/o a trailing one after it, or a trailing surrogate at k w/o a
+		// leading one before it
+		return ((expect_trailing >> k) & 1u) ? k-1 : k;
+	}
+	carry = (b.leading >> (n_words-1)) & 1u;
+	return n_words;
+}
+#endif
+
+std::size_t byteswap_and_validate_utf16(std::span<const std::uint16_t> src, std::span<std::uint16_t> dest) {
+	std::size_t i {0};
+	std::size_t first_invalid = src.size();
+	bool expect_trailing {false};
+#ifdef UTFLIB_SSE2
+	unsigned carry {0};
+	for (; i+16 <= src.size(); i+=16) {
+		__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data()+i));
+		__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data()+i+8));
+		v0 = _mm_or_si128(_mm_slli_epi16(v0, 8), _mm_srli_epi16(v0, 8));
+		v1 = _mm_or_si128(_mm_slli_epi16(v1, 8), _mm_srli_epi16(v1, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest.data()+i), v0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest.data()+i+8), v1);
+		if (first_invalid != src.size()) {
+			continue;
+		}
+		const std::ptrdiff_t k = check_utf16_pairing(classify_utf16_surrogates(v0, v1), carry, 16);
+		if (k != 16) {
+			first_invalid = i + k;
+		}
+	}
+	expect_trailing = (carry != 0);
+#endif
+	std::size_t tail_beg = i;
+	for (; i<src.size(); ++i) {
+		dest[i] = reverse_bytes(src[i]);
+	}
+	if (first_invalid == src.size()) {
+		first_invalid = validate_utf16_range(dest, tail_beg, src.size(), expect_trailing);
+		if (first_invalid == src.size() && expect_trailing) {
+			first_invalid = src.size()-1;  // Ends on a leading surrogate
+		}
+	}
+	return first_invalid;
+}
+
+// Shared by validate_utf16 and validate_utf16_swapped.  Only the surrogates matter to the vector loop,
+// so swapped input is classified w/ swapped masks and never byte-swapped; s is not modified.
+template<bool swapped>
+static std::size_t validate_utf16_impl(std::span<const std::uint16_t> s) {
+	std::size_t i {0};
+	bool expect_trailing {false};
+#ifdef UTFLIB_SSE2
+	unsigned carry {0};
+	for (; i+16 <= s.size(); i+=16) {
+		const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i));
+		const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i+8));
+		const std::ptrdiff_t k = check_utf16_pairing(classify_utf16_surrogates<swapped>(v0, v1), carry, 16);
+		if (k != 16) {
+			return i + k;
+		}
+	}
+	expect_trailing = (carry != 0);
+#endif
+	std::size_t r = validate_utf16_range<swapped>(s, i, s.size(), expect_trailing);
+	if (r == s.size() && expect_trailing) {
+		r = s.size()-1;  // Ends on a leading surrogate
+	}
+	return r;
+}
+
+std::size_t validate_utf16(std::span<const std::uint16_t> s) {
+	return validate_utf16_impl<false>(s);
+}
+
+std::size_t validate_utf16_swapped(std::span<const std::uint16_t> s) {
+	return validate_utf16_impl<true>(s);
+}
+
+#ifdef UTFLIB_SSE2
+// Byte-reverses each of the 32-bit lanes of v
+static __m128i byteswap_epi32(__m128i v) {
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2,3,0,1));
+	return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// All-ones in the lanes of v that are not valid utf-32:  v > 0x10FFFF || (v - 0xD800) < 0x800.  SSE2 only
+// has signed 32-bit compares; flipping the sign bit of both operands turns them into unsigned compares.
+static __m128i invalid_utf32_lanes(__m128i v) {
+	const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+	const __m128i max_cp = _mm_set1_epi32(static_cast<int>(0x10FFFFu ^ 0x80000000u));
+	const __m128i surr_beg = _mm_set1_epi32(0xD800);
+	const __m128i surr_len = _mm_set1_epi32(static_cast<int>(0x800u ^ 0x80000000u));
+	const __m128i too_big = _mm_cmpgt_epi32(_mm_xor_si128(v, bias), max_cp);
+	const __m128i is_surr = _mm_cmplt_epi32(_mm_xor_si128(_mm_sub_epi32(v, surr_beg), bias), surr_len);
+	return _mm_or_si128(too_big, is_surr);
+}
+#endif
+
+std::size_t byteswap_and_validate_utf32(std::span<const std::uint32_t> src, std::span<std::uint32_t> dest) {
+	std::size_t i {0};
+	std::size_t first_invalid = src.size();
+#ifdef UTFLIB_SSE2
+	for (; i+4 <= src.size(); i+=4) {
+		const __m128i v = byteswap_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data()+i)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest.data()+i), v);
+		if (first_invalid != src.size()) {
+			continue;
+		}
+		const int m = _mm_movemask_epi8(invalid_utf32_lanes(v));
+		if (m != 0) {
+			first_invalid = i + std::countr_zero(static_cast<unsigned>(m))/4;
+		}
+	}
+#endif
+	for (; i<src.size(); ++i) {
+		dest[i] = reverse_bytes(src[i]);
+		if (first_invalid == src.size() && !is_valid_utf32_codepoint(dest[i])) {
+			first_invalid = i;
+		}
+	}
+	return first_invalid;
+}
+
+// Shared by validate_utf32 and validate_utf32_swapped.  Eight code units (two vectors) per step; the
+// two masks are or'ed together so that there is one branch per step.
+template<bool swapped>
+static std::size_t validate_utf32_impl(std::span<const std::uint32_t> s) {
+	std::size_t i {0};
+#ifdef UTFLIB_SSE2
+	for (; i+8 <= s.size(); i+=8) {
+		__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i));
+		__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()+i+4));
+		if constexpr (swapped) {
+			v0 = byteswap_epi32(v0);
+			v1 = byteswap_epi32(v1);
+		}
+		const __m128i bad0 = invalid_utf32_lanes(v0);
+		const __m128i bad1 = invalid_utf32_lanes(v1);
+		if (_mm_movemask_epi8(_mm_or_si128(bad0, bad1)) != 0) {
+			const unsigned m = static_cast<unsigned>(_mm_movemask_epi8(bad0))
+				| (static_cast<unsigned>(_mm_movemask_epi8(bad1)) << 16);
+			return i + std::countr_zero(m)/4;
+		}
+	}
+#endif
+	for (; i<s.size(); ++i) {
+		const bool is_valid = swapped ? is_valid_utf32_codepoint_reversed(s[i]) : is_valid_utf32_codepoint(s[i]);
+		if (!is_valid) {
+			return i;
+		}
+	}
+	return s.size();
+}
+
+std::size_t validate_utf32(std::span<const std::uint32_t> s) {
+	return validate_utf32_impl<false>(s);
+}
+
+std::size_t validate_utf32_swapped(std::span<const std::uint32_t> s) {
+	return validate_utf32_impl<true>(s);
+}